@@ -1190,6 +1190,122 @@ fs::native_handle fs::file::get_handle() const
 #endif
 }
 
+fs::file_view::file_view(const fs::file& f)
+{
+	if (!f)
+	{
+		return;
+	}
+
+	const u64 size = f.size();
+
+	if (size == 0 || size != static_cast<std::size_t>(size))
+	{
+		return;
+	}
+
+	const native_handle handle = f.get_handle();
+
+#ifdef _WIN32
+	if (handle != INVALID_HANDLE_VALUE)
+	{
+		if (const HANDLE map = CreateFileMappingW(handle, NULL, PAGE_READONLY, DWORD(size >> 32), DWORD(size), NULL))
+		{
+			if (const auto ptr = MapViewOfFile(map, FILE_MAP_READ, 0, 0, static_cast<std::size_t>(size)))
+			{
+				m_ptr = static_cast<const uchar*>(ptr);
+				m_size = size;
+				m_map = map;
+				return;
+			}
+
+			CloseHandle(map);
+		}
+	}
+#else
+	if (handle != -1)
+	{
+		const auto ptr = ::mmap(nullptr, static_cast<std::size_t>(size), PROT_READ, MAP_SHARED, handle, 0);
+
+		if (ptr != MAP_FAILED)
+		{
+			m_ptr = static_cast<const uchar*>(ptr);
+			m_size = size;
+			m_map = ptr;
+			return;
+		}
+	}
+#endif
+
+	// Fallback: read the whole file (virtual devices, mapping failure)
+	const u64 pos = f.pos();
+
+	m_copy.resize(static_cast<std::size_t>(size));
+
+	if (f.seek(0), f.read(m_copy.data(), size) != size)
+	{
+		m_copy.clear();
+	}
+	else
+	{
+		m_ptr = m_copy.data();
+		m_size = size;
+	}
+
+	f.seek(pos);
+}
+
+fs::file_view::file_view(fs::file_view&& other)
+	: m_ptr(other.m_ptr)
+	, m_size(other.m_size)
+	, m_map(other.m_map)
+	, m_copy(std::move(other.m_copy))
+{
+	other.m_ptr = nullptr;
+	other.m_size = 0;
+	other.m_map = nullptr;
+}
+
+fs::file_view& fs::file_view::operator=(fs::file_view&& other)
+{
+	if (this != &other)
+	{
+		close();
+		m_ptr = other.m_ptr;
+		m_size = other.m_size;
+		m_map = other.m_map;
+		m_copy = std::move(other.m_copy);
+		other.m_ptr = nullptr;
+		other.m_size = 0;
+		other.m_map = nullptr;
+	}
+
+	return *this;
+}
+
+fs::file_view::~file_view()
+{
+	close();
+}
+
+void fs::file_view::close()
+{
+	if (m_map)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_ptr);
+		CloseHandle(m_map);
+#else
+		::munmap(m_map, static_cast<std::size_t>(m_size));
+#endif
+	}
+
+	m_ptr = nullptr;
+	m_size = 0;
+	m_map = nullptr;
+	m_copy.clear();
+}
+
 void fs::dir::xnull() const
 {
 	fmt::throw_exception<std::logic_error>("fs::dir is null");
@@ -368,6 +368,104 @@ namespace fs
 		native_handle get_handle() const;
 	};
 
+	// Read-only view of the file contents (memory-mapped if possible, copied otherwise)
+	class file_view final
+	{
+		const uchar* m_ptr = nullptr;
+		u64 m_size = 0;
+
+		// Mapping handle (or null if the data was copied)
+		void* m_map = nullptr;
+
+		// Fallback storage
+		std::vector<uchar> m_copy;
+
+	public:
+		file_view() = default;
+
+		// Map the whole file (current size)
+		explicit file_view(const file& f);
+
+		file_view(const file_view&) = delete;
+
+		file_view& operator=(const file_view&) = delete;
+
+		file_view(file_view&& other);
+
+		file_view& operator=(file_view&& other);
+
+		~file_view();
+
+		// Unmap explicitly
+		void close();
+
+		explicit operator bool() const
+		{
+			return m_ptr != nullptr;
+		}
+
+		const uchar* data() const
+		{
+			return m_ptr;
+		}
+
+		u64 size() const
+		{
+			return m_size;
+		}
+
+		// Check whether the data is actually memory-mapped
+		bool is_mapped() const
+		{
+			return m_map != nullptr;
+		}
+	};
+
+	// Map the file and validate its records (append-only storage, records start at offset begin).
+	// parse(pos, data, avail) returns the size of the record at pos (avail bytes are mapped) or 0 if it's damaged.
+	// The file is truncated after the last valid record. Returns its end, or 0 if the file can't be mapped (view is empty).
+	template <typename F>
+	u64 map_records(const file& f, file_view& view, u64 begin, F&& parse)
+	{
+		view = file_view(f);
+
+		if (!view || view.size() < begin)
+		{
+			view.close();
+			return 0;
+		}
+
+		u64 end = begin;
+
+		while (end < view.size())
+		{
+			const u64 size = parse(end, view.data() + end, view.size() - end);
+
+			if (size == 0 || size > view.size() - end)
+			{
+				break;
+			}
+
+			end += size;
+		}
+
+		if (end < view.size())
+		{
+			// Discard the damaged tail
+			view.close();
+			f.trunc(end);
+			view = file_view(f);
+
+			if (!view || view.size() != end)
+			{
+				view.close();
+				return 0;
+			}
+		}
+
+		return end;
+	}
+
 	class dir final
 	{
 		std::unique_ptr<dir_base> m_dir;
@@ -136,12 +136,15 @@ struct MemoryManager : llvm::RTDyldMemoryManager
 {
 	std::unordered_map<std::string, u64>& m_link;
 
+	const std::function<u64(const std::string&)>& m_resolve;
+
 	std::array<u8, 16>* m_tramps{};
 
 	u8* m_code_addr{}; // TODO
 
-	MemoryManager(std::unordered_map<std::string, u64>& table)
+	MemoryManager(std::unordered_map<std::string, u64>& table, const std::function<u64(const std::string&)>& resolve)
 		: m_link(table)
+		, m_resolve(resolve)
 	{
 	}
 
@@ -155,6 +158,11 @@ struct MemoryManager : llvm::RTDyldMemoryManager
 		auto& addr = m_link[name];
 
 		// Find function address
+		if (!addr && m_resolve)
+		{
+			addr = m_resolve(name);
+		}
+
 		if (!addr)
 		{
 			addr = RTDyldMemoryManager::getSymbolAddress(name);
@@ -320,6 +328,12 @@ struct MemoryManager2 : llvm::RTDyldMemoryManager
 	u64 m_code_pos = 0;
 	u64 m_data_pos = 0;
 
+	// External symbols (name -> address)
+	std::unordered_map<std::string, u64> m_link;
+
+	// Trampolines to external symbols (name -> address)
+	std::unordered_map<std::string, u64> m_tramps;
+
 	MemoryManager2() = default;
 
 	~MemoryManager2() override
@@ -327,6 +341,36 @@ struct MemoryManager2 : llvm::RTDyldMemoryManager
 		utils::memory_release(m_memory, 0x80000000);
 	}
 
+	llvm::JITSymbol findSymbol(const std::string& name) override
+	{
+		const auto found = m_link.find(name);
+
+		if (found == m_link.end())
+		{
+			return RTDyldMemoryManager::findSymbol(name);
+		}
+
+		auto& addr = m_tramps[name];
+
+		if (!addr)
+		{
+			// Create a trampoline in the code area (reachable from the small code model)
+			const auto data = allocateCodeSection(16, 16, 0, "__tramp");
+			data[0x0] = 0xff; // JMP [rip+2]
+			data[0x1] = 0x25;
+			data[0x2] = 0x02;
+			data[0x3] = 0x00;
+			data[0x4] = 0x00;
+			data[0x5] = 0x00;
+			data[0x6] = 0x48; // MOV rax, imm64 (not executed)
+			data[0x7] = 0xb8;
+			std::memcpy(data + 8, &found->second, 8);
+			addr = (u64)data;
+		}
+
+		return {addr, llvm::JITSymbolFlags::Exported};
+	}
+
 	u8* allocateCodeSection(std::uintptr_t size, uint align, uint sec_id, llvm::StringRef sec_name) override
 	{
 		// Simple allocation
@@ -459,7 +503,10 @@ public:
 	{
 		std::string name = m_path;
 		name.append(module->getName());
-		fs::file(name, fs::rewrite).write(obj.getBufferStart(), obj.getBufferSize());
+
+		// Write to a temporary file first, so an interrupted write can't leave a damaged object
+		fs::file(name + ".tmp", fs::rewrite).write(obj.getBufferStart(), obj.getBufferSize());
+		fs::rename(name + ".tmp", name, true);
 		LOG_NOTICE(GENERAL, "LLVM: Created module: %s", module->getName().data());
 	}
 
@@ -529,8 +576,9 @@ std::string jit_compiler::cpu(const std::string& _cpu)
 	return m_cpu;
 }
 
-jit_compiler::jit_compiler(const std::unordered_map<std::string, u64>& _link, const std::string& _cpu, bool large)
+jit_compiler::jit_compiler(const std::unordered_map<std::string, u64>& _link, const std::string& _cpu, bool large, std::function<u64(const std::string&)> _resolve)
 	: m_link(_link)
+	, m_resolve(std::move(_resolve))
 	, m_cpu(cpu(_cpu))
 {
 	std::string result;
@@ -538,10 +586,13 @@ jit_compiler::jit_compiler(const std::unordered_map<std::string, u64>& _link, co
 	if (m_link.empty())
 	{
 		// Auxiliary JIT (does not use custom memory manager, only writes the objects)
+		auto mem = std::make_unique<MemoryManager2>();
+		m_aux_mem = mem.get();
+
 		m_engine.reset(llvm::EngineBuilder(std::make_unique<llvm::Module>("null_", m_context))
 			.setErrorStr(&result)
 			.setEngineKind(llvm::EngineKind::JIT)
-			.setMCJITMemoryManager(std::make_unique<MemoryManager2>())
+			.setMCJITMemoryManager(std::move(mem))
 			.setOptLevel(llvm::CodeGenOpt::Aggressive)
 			.setCodeModel(large ? llvm::CodeModel::Large : llvm::CodeModel::Small)
 			.setMCPU(m_cpu)
@@ -550,7 +601,7 @@ jit_compiler::jit_compiler(const std::unordered_map<std::string, u64>& _link, co
 	else
 	{
 		// Primary JIT
-		auto mem = std::make_unique<MemoryManager>(m_link);
+		auto mem = std::make_unique<MemoryManager>(m_link, m_resolve);
 		m_jit_el = std::make_unique<EventListener>(*mem);
 
 		m_engine.reset(llvm::EngineBuilder(std::make_unique<llvm::Module>("null", m_context))
@@ -632,6 +683,12 @@ void jit_compiler::add(const std::string& path)
 	m_engine->addObjectFile(std::move(llvm::object::ObjectFile::createObjectFile(*ObjectCache::load(path)).get()));
 }
 
+void jit_compiler::add_symbol(const std::string& name, u64 addr)
+{
+	verify(HERE), m_aux_mem;
+	m_aux_mem->m_link.emplace(name, addr);
+}
+
 void jit_compiler::fin()
 {
 	m_engine->finalizeObject();
@@ -7,6 +7,9 @@
 #include <array>
 #include <functional>
 
+#include "types.h"
+#include "sema.h"
+
 namespace asmjit
 {
 	// Should only be used to build global functions
@@ -57,6 +60,20 @@ FT build_function_asm(F&& builder)
 	return result;
 }
 
+// Global limit of simultaneously working JIT compilation threads (PPU LLVM, SPU cache)
+struct jit_core_allocator
+{
+	const s32 thread_count;
+
+	::semaphore<0x7fffffff> sem;
+
+	jit_core_allocator(s32 arg)
+		: thread_count(arg)
+		, sem(arg)
+	{
+	}
+};
+
 #ifdef LLVM_AVAILABLE
 
 #include <memory>
@@ -90,14 +107,20 @@ class jit_compiler final
 	// Execution instance
 	std::unique_ptr<llvm::ExecutionEngine> m_engine;
 
+	// Memory manager of the auxiliary JIT (owned by m_engine)
+	struct MemoryManager2* m_aux_mem{};
+
 	// Link table
 	std::unordered_map<std::string, u64> m_link;
 
+	// Fallback for symbols not found in the link table (optional)
+	std::function<u64(const std::string&)> m_resolve;
+
 	// Arch
 	std::string m_cpu;
 
 public:
-	jit_compiler(const std::unordered_map<std::string, u64>& _link, const std::string& _cpu, bool large = false);
+	jit_compiler(const std::unordered_map<std::string, u64>& _link, const std::string& _cpu, bool large = false, std::function<u64(const std::string&)> _resolve = nullptr);
 	~jit_compiler();
 
 	// Get LLVM context
@@ -123,6 +146,9 @@ public:
 	// Add object (path to obj file)
 	void add(const std::string& path);
 
+	// Add external symbol, resolved through a trampoline (auxiliary JIT only)
+	void add_symbol(const std::string& name, u64 addr);
+
 	// Finalize
 	void fin();
 
@@ -7,9 +7,11 @@
 #include "Utilities/Thread.h"
 #include "rpcs3_version.h"
 #include <cstring>
+#include <cstdio>
 #include <cstdarg>
 #include <string>
 #include <unordered_map>
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <cstring>
@@ -34,6 +36,9 @@ static std::string empty_string()
 // Thread-specific log prefix provider
 thread_local std::string(*g_tls_log_prefix)() = &empty_string;
 
+// Thread-specific raw log prefix provider (deferred mode, g_tls_log_prefix is used if not set)
+thread_local logs::raw_prefix(*g_tls_log_raw_prefix)() = nullptr;
+
 template<>
 void fmt_class_string<logs::level>::format(std::string& out, u64 arg)
 {
@@ -118,11 +123,44 @@ namespace logs
 		std::string text;
 	};
 
+	// Max number of arguments stored in deferred message
+	constexpr std::size_t s_deferred_args = 8;
+
+	struct deferred_message
+	{
+		message m;
+		u64 stamp;
+		std::string prefix; // Thread name or ready prefix
+		u64 addr; // Address appended to the prefix
+		u32 addr_digits; // Address width (no address if 0)
+		std::string text; // Ready text (if fmt is null)
+		const char* fmt;
+		const fmt_type_info* sup;
+		u64 args[s_deferred_args];
+	};
+
+	// Preallocated queue of deferred messages of one thread (single producer, consumed under g_deferred_mutex)
+	struct deferred_ring
+	{
+		static constexpr u32 size = 128;
+
+		deferred_message slots[size]{};
+
+		// Number of messages pushed (written by the owner thread)
+		atomic_t<u32> head{0};
+
+		// Number of messages consumed (written by the writer thread)
+		atomic_t<u32> tail{0};
+
+		// Set on thread exit, the ring is deleted by the writer thread when it's empty
+		atomic_t<bool> closed{false};
+	};
+
 	struct file_listener : public file_writer, public listener
 	{
 		file_listener(const std::string& name);
 
-		virtual ~file_listener() = default;
+		virtual ~file_listener();
 
 		// Encode level, current thread name, channel name and write log message
 		virtual void log(u64 stamp, const message& msg, const std::string& prefix, const std::string& text) override;
@@ -188,6 +226,36 @@ namespace logs
 	// Must be set to true in main()
 	atomic_t<bool> g_init{false};
 
+	// Deferred mode: messages are queued and formatted on the writer thread
+	atomic_t<bool> g_deferred{false};
+
+	// Deferred queue consumer mutex (keeps message order), also protects g_deferred_rings
+	semaphore<> g_deferred_mutex;
+
+	// Queues of all threads which sent deferred messages
+	std::vector<deferred_ring*> g_deferred_rings;
+
+	// Deferred queue of the current thread (created on first use)
+	thread_local deferred_ring* g_tls_deferred_ring = nullptr;
+
+	// Set after the thread-local destructors ran (deferred mode is not available anymore)
+	thread_local bool g_tls_deferred_closed = false;
+
+	// Closes the queue of the current thread on exit
+	static thread_local struct deferred_ring_guard
+	{
+		~deferred_ring_guard()
+		{
+			if (g_tls_deferred_ring)
+			{
+				g_tls_deferred_ring->closed = true;
+			}
+
+			g_tls_deferred_ring = nullptr;
+			g_tls_deferred_closed = true;
+		}
+	} g_tls_deferred_guard;
+
 	void reset()
 	{
 		std::lock_guard lock(g_mutex);
@@ -215,6 +283,172 @@ namespace logs
 			g_init = true;
 		}
 	}
+
+	void set_deferred(bool value)
+	{
+		g_deferred = value;
+
+		if (!value)
+		{
+			flush_deferred();
+		}
+	}
+
+	void flush_deferred()
+	{
+		std::lock_guard lock(g_deferred_mutex);
+
+		// Collect pending messages of all threads
+		std::vector<std::pair<deferred_ring*, u32>> rings;
+		std::vector<deferred_message*> batch;
+		std::string prefix;
+
+		for (deferred_ring* ring : g_deferred_rings)
+		{
+			const u32 head = ring->head;
+
+			for (u32 i = ring->tail; i != head; i++)
+			{
+				batch.push_back(&ring->slots[i % deferred_ring::size]);
+			}
+
+			rings.emplace_back(ring, head);
+		}
+
+		// Merge threads by timestamp (stable: timestamps of a thread never decrease)
+		std::stable_sort(batch.begin(), batch.end(), [](const deferred_message* a, const deferred_message* b)
+		{
+			return a->stamp < b->stamp;
+		});
+
+		for (deferred_message* msg : batch)
+		{
+			if (msg->fmt)
+			{
+				msg->text.clear();
+				fmt::raw_append(msg->text, msg->fmt, msg->sup, msg->args);
+			}
+
+			prefix = msg->prefix;
+
+			if (msg->addr_digits)
+			{
+				char addr[32];
+				std::snprintf(addr, sizeof(addr), " [0x%0*llx]", static_cast<int>(msg->addr_digits), static_cast<unsigned long long>(msg->addr));
+				prefix += addr;
+			}
+
+			for (listener* lis = get_logger(); lis; lis = lis->m_next)
+			{
+				lis->log(msg->stamp, msg->m, prefix, msg->text);
+			}
+		}
+
+		// Release slots, delete queues of finished threads
+		for (const auto& [ring, head] : rings)
+		{
+			ring->tail = head;
+
+			if (ring->closed && ring->head == head)
+			{
+				g_deferred_rings.erase(std::find(g_deferred_rings.begin(), g_deferred_rings.end(), ring));
+				delete ring;
+			}
+		}
+	}
+
+	// Register channel, returns false if the message must be dropped
+	static bool check_channel(const message& msg)
+	{
+		const auto ch = msg.ch;
+
+		if (ch->enabled == level::_uninit)
+		{
+			std::lock_guard lock(g_mutex);
+
+			auto& info = get_logger()->channels[ch->name];
+
+			if (info.pointer && info.pointer != ch)
+			{
+				fmt::throw_exception("logs::channel repetition: %s", ch->name);
+			}
+			else if (!info.pointer)
+			{
+				info.pointer = ch;
+				ch->enabled  = info.enabled;
+
+				// Check level again
+				if (info.enabled < msg.sev)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Get the next slot of the current thread's deferred queue (returns nullptr if not available)
+	static deferred_message* begin_deferred(const message& m, u64 stamp)
+	{
+		if (!g_deferred || !g_init || g_tls_deferred_closed)
+		{
+			return nullptr;
+		}
+
+		if (!g_tls_deferred_ring)
+		{
+			// Touch the guard to register its destructor
+			static_cast<void>(&g_tls_deferred_guard);
+
+			g_tls_deferred_ring = new deferred_ring;
+
+			std::lock_guard lock(g_deferred_mutex);
+			g_deferred_rings.push_back(g_tls_deferred_ring);
+		}
+
+		deferred_ring& ring = *g_tls_deferred_ring;
+
+		if (ring.head.load() - ring.tail.load() >= deferred_ring::size)
+		{
+			// Queue is full, don't wait for the writer thread
+			flush_deferred();
+		}
+
+		deferred_message& msg = ring.slots[ring.head % deferred_ring::size];
+		msg.m = m;
+		msg.stamp = stamp;
+
+		// Capture the thread name and the address instead of formatting the prefix
+		if (g_tls_log_raw_prefix)
+		{
+			const raw_prefix info = g_tls_log_raw_prefix();
+			msg.prefix.assign(info.name.data(), info.name.size());
+			msg.addr = info.addr;
+			msg.addr_digits = info.addr_digits;
+		}
+		else
+		{
+			msg.prefix = g_tls_log_prefix();
+			msg.addr_digits = 0;
+		}
+
+		return &msg;
+	}
+
+	// Publish the slot obtained by begin_deferred()
+	static void end_deferred(const message& m)
+	{
+		// Only the owner thread writes the head, no need for atomic increment
+		auto& head = g_tls_deferred_ring->head;
+		head = head.load() + 1;
+
+		if (m.sev == level::fatal)
+		{
+			// Don't leave fatal messages in the queue
+			flush_deferred();
+		}
+	}
 }
 
 logs::listener::~listener()
@@ -241,33 +475,60 @@ void logs::listener::add(logs::listener* _new)
 	}
 }
 
-void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) const
+void logs::message::defer(const char* fmt, const fmt_type_info* sup, ...) const
 {
 	// Get timestamp
 	const u64 stamp = get_stamp();
 
 	// Register channel
-	if (ch->enabled == level::_uninit)
+	if (!check_channel(*this))
 	{
-		std::lock_guard lock(g_mutex);
+		return;
+	}
+
+	// Extract va_args
+	thread_local std::vector<u64> args;
+
+	std::size_t args_count = 0;
+	for (auto v = sup; v->fmt_string; v++)
+		args_count++;
 
-		auto& info = get_logger()->channels[ch->name];
+	args.resize(args_count);
+
+	va_list c_args;
+	va_start(c_args, sup);
+	for (u64& arg : args)
+		arg = va_arg(c_args, u64);
+	va_end(c_args);
 
-		if (info.pointer && info.pointer != ch)
+	if (args_count <= s_deferred_args)
+	{
+		if (const auto msg = begin_deferred(*this, stamp))
 		{
-			fmt::throw_exception("logs::channel repetition: %s", ch->name);
+			// Copy raw arguments, formatting is done by the writer thread
+			msg->fmt = fmt;
+			msg->sup = sup;
+			std::copy(args.begin(), args.end(), msg->args);
+			end_deferred(*this);
+			return;
 		}
-		else if (!info.pointer)
-		{
-			info.pointer = ch;
-			ch->enabled  = info.enabled;
+	}
 
-			// Check level again
-			if (info.enabled < sev)
-			{
-				return;
-			}
-		}
+	thread_local std::string text;
+	text.clear();
+	fmt::raw_append(text, fmt, sup, args.data());
+	send(stamp, text);
+}
+
+void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) const
+{
+	// Get timestamp
+	const u64 stamp = get_stamp();
+
+	// Register channel
+	if (!check_channel(*this))
+	{
+		return;
 	}
 
 	// Get text, extract va_args
@@ -286,7 +547,32 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) co
 	for (u64& arg : args)
 		arg = va_arg(c_args, u64);
 	va_end(c_args);
+
+	if (const auto msg = begin_deferred(*this, stamp))
+	{
+		// Format into the queue slot, arguments may not outlive the call (keeps message order)
+		msg->fmt = nullptr;
+		msg->text.clear();
+		fmt::raw_append(msg->text, fmt, sup, args.data());
+		end_deferred(*this);
+		return;
+	}
+
 	fmt::raw_append(text, fmt, sup, args.data());
+	send(stamp, text);
+}
+
+void logs::message::send(u64 stamp, const std::string& text) const
+{
+	if (const auto msg = begin_deferred(*this, stamp))
+	{
+		// Keep message order
+		msg->fmt = nullptr;
+		msg->text = text;
+		end_deferred(*this);
+		return;
+	}
+
 	std::string prefix = g_tls_log_prefix();
 
 	// Get first (main) listener
@@ -409,6 +695,12 @@ logs::file_writer::file_writer(const std::string& name)
 
 		while (true)
 		{
+			if (g_deferred)
+			{
+				// Format queued messages
+				flush_deferred();
+			}
+
 			const u64 bufv = m_buf;
 
 			if (bufv & 0xffffff)
@@ -605,6 +897,13 @@ logs::file_listener::file_listener(const std::string& name)
 	messages.emplace_back(std::move(ver));
 }
 
+logs::file_listener::~file_listener()
+{
+	// Write remaining messages
+	g_deferred = false;
+	flush_deferred();
+}
+
 void logs::file_listener::log(u64 stamp, const logs::message& msg, const std::string& prefix, const std::string& _text)
 {
 	thread_local std::string text;
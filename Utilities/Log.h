@@ -4,6 +4,7 @@
 #include "Atomic.h"
 #include "StrFmt.h"
 #include <climits>
+#include <string_view>
 
 namespace logs
 {
@@ -23,6 +24,18 @@ namespace logs
 
 	struct channel;
 
+	// Log prefix captured by the calling thread instead of formatting it (deferred mode)
+	struct raw_prefix
+	{
+		std::string_view name; // Thread name (copied by the caller)
+		u64 addr = 0; // Address appended to the name
+		u32 addr_digits = 0; // Address width in hex digits (no address if 0)
+	};
+
+	// Argument types which can be safely formatted after the caller returns
+	template <typename T>
+	constexpr bool is_deferrable = std::is_arithmetic<T>::value || std::is_enum<T>::value;
+
 	// Message information
 	struct message
 	{
@@ -33,6 +46,12 @@ namespace logs
 		// Send log message to global logger instance
 		void broadcast(const char*, const fmt_type_info*, ...) const;
 
+		// Send log message with arguments passed by value (formatting can be deferred to the writer thread)
+		void defer(const char*, const fmt_type_info*, ...) const;
+
+		// Send formatted log message
+		void send(u64 stamp, const std::string& text) const;
+
 		friend struct channel;
 	};
 
@@ -42,6 +61,7 @@ namespace logs
 		atomic_t<listener*> m_next{};
 
 		friend struct message;
+		friend void flush_deferred();
 
 	public:
 		constexpr listener() = default;
@@ -78,7 +98,10 @@ namespace logs
 			if (UNLIKELY(level::_sev <= enabled))\
 			{\
 				static constexpr fmt_type_info type_list[sizeof...(Args) + 1]{fmt_type_info::make<fmt_unveil_t<Args>>()...};\
-				msg_##_sev.broadcast(fmt, type_list, u64{fmt_unveil<Args>::get(args)}...);\
+				if constexpr (sizeof...(Args) > 0 && (is_deferrable<fmt_unveil_t<Args>> && ...))\
+					msg_##_sev.defer(fmt, type_list, u64{fmt_unveil<Args>::get(args)}...);\
+				else\
+					msg_##_sev.broadcast(fmt, type_list, u64{fmt_unveil<Args>::get(args)}...);\
 			}\
 		}
 
@@ -108,6 +131,12 @@ namespace logs
 
 	// Log level control: register channel if necessary, set channel level
 	void set_level(const std::string&, level);
+
+	// Log mode control: format messages with simple arguments on the writer thread
+	void set_deferred(bool);
+
+	// Format queued messages and send them to listeners (deferred mode)
+	void flush_deferred();
 }
 
 #define LOG_CHANNEL(ch, ...) ::logs::channel ch(#ch, ##__VA_ARGS__);
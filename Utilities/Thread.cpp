@@ -9,6 +9,8 @@
 #include "sysinfo.h"
 #include <typeinfo>
 #include <thread>
+#include <map>
+#include <set>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -41,6 +43,7 @@ thread_local u64 g_tls_fault_all = 0;
 thread_local u64 g_tls_fault_rsx = 0;
 thread_local u64 g_tls_fault_spu = 0;
 extern thread_local std::string(*g_tls_log_prefix)();
+extern thread_local logs::raw_prefix(*g_tls_log_raw_prefix)();
 
 [[noreturn]] void catch_all_exceptions()
 {
@@ -1603,6 +1606,11 @@ void thread_base::initialize()
 		return thread_ctrl::g_tls_this_thread->m_name.get();
 	};
 
+	g_tls_log_raw_prefix = []
+	{
+		return logs::raw_prefix{thread_ctrl::get_name()};
+	};
+
 	++g_thread_count;
 
 #ifdef _MSC_VER
@@ -1670,6 +1678,11 @@ bool thread_base::finalize(int) noexcept
 		return thread_ctrl::g_tls_this_thread->m_name.get();
 	};
 
+	g_tls_log_raw_prefix = []
+	{
+		return logs::raw_prefix{thread_ctrl::get_name()};
+	};
+
 	LOG_NOTICE(GENERAL, "Thread time: %fs (%fGc); Faults: %u [rsx:%u, spu:%u];",
 		time / 1000000000.,
 		cycles / 1000000000.,
@@ -1689,6 +1702,7 @@ bool thread_base::finalize(int) noexcept
 void thread_base::finalize() noexcept
 {
 	g_tls_log_prefix = []() -> std::string { return {}; };
+	g_tls_log_raw_prefix = nullptr;
 	thread_ctrl::g_tls_this_thread = nullptr;
 	--g_thread_count;
 }
@@ -1804,29 +1818,193 @@ u64 thread_base::get_cycles()
 	}
 }
 
+u32 host_cpu_set::count() const
+{
+	u32 result = 0;
+
+	for (u64 bits : m_bits)
+	{
+		for (; bits; bits &= bits - 1)
+		{
+			result++;
+		}
+	}
+
+	return result;
+}
+
+std::string host_cpu_set::to_string() const
+{
+	std::string result;
+
+	for (u32 i = 0; i < width(); i++)
+	{
+		if (!test(i))
+		{
+			continue;
+		}
+
+		u32 last = i;
+
+		while (last + 1 < width() && test(last + 1))
+		{
+			last++;
+		}
+
+		if (!result.empty())
+		{
+			result += ',';
+		}
+
+		if (last == i)
+		{
+			fmt::append(result, "%u", i);
+		}
+		else
+		{
+			fmt::append(result, "%u-%u", i, last);
+		}
+
+		i = last;
+	}
+
+	return result;
+}
+
+// Host CPU layout used for thread placement
+struct host_cpu_layout
+{
+	std::vector<utils::cpu_topology_entry> cpus;
+
+	host_cpu_set all;
+
+	// CPUs of the preferred NUMA node (the largest one)
+	host_cpu_set node;
+	u32 node_id = 0;
+
+	// Last level cache domains of the preferred NUMA node
+	std::vector<host_cpu_set> domains;
+
+	u32 cores = 0;
+	u32 packages = 0;
+	u32 nodes = 0;
+	u32 caches = 0;
+
+	host_cpu_layout()
+		: cpus(utils::get_cpu_topology())
+	{
+		std::map<u32, u32> node_sizes;
+		std::set<u32> core_set, package_set, cache_set;
+
+		for (const auto& cpu : cpus)
+		{
+			all.set(cpu.id);
+			node_sizes[cpu.node]++;
+			core_set.emplace(cpu.core);
+			package_set.emplace(cpu.package);
+			cache_set.emplace(cpu.cache);
+		}
+
+		cores = ::size32(core_set);
+		packages = ::size32(package_set);
+		nodes = ::size32(node_sizes);
+		caches = ::size32(cache_set);
+
+		for (const auto& pair : node_sizes)
+		{
+			if (pair.second > node_sizes[node_id])
+			{
+				node_id = pair.first;
+			}
+		}
+
+		std::map<u32, host_cpu_set> domain_map;
+
+		for (const auto& cpu : cpus)
+		{
+			if (cpu.node == node_id)
+			{
+				node.set(cpu.id);
+				domain_map[cpu.cache].set(cpu.id);
+			}
+		}
+
+		for (auto& pair : domain_map)
+		{
+			domains.emplace_back(std::move(pair.second));
+		}
+	}
+};
+
+static const host_cpu_layout& get_cpu_layout()
+{
+	static const host_cpu_layout s_layout;
+	return s_layout;
+}
+
+// SPU thread group -> cache domain index
+static shared_mutex s_spu_domain_mutex;
+static std::unordered_map<u32, u32> s_spu_domains;
+
 void thread_ctrl::detect_cpu_layout()
 {
 	if (!g_native_core_layout.compare_and_swap_test(native_core_arrangement::undefined, native_core_arrangement::generic))
 		return;
 
+	const auto& layout = get_cpu_layout();
+
 	const auto system_id = utils::get_system_info();
 	if (system_id.find("Ryzen") != std::string::npos)
 	{
 		g_native_core_layout.store(native_core_arrangement::amd_ccx);
 	}
-
-	// TODO: Detect hyperthreaded intel CPUs
+	else if (layout.cores < layout.cpus.size())
+	{
+		g_native_core_layout.store(native_core_arrangement::intel_ht);
+	}
 }
 
-u16 thread_ctrl::get_affinity_mask(thread_class group)
+void thread_ctrl::init_thread_placement()
 {
 	detect_cpu_layout();
 
+	const auto& layout = get_cpu_layout();
+	const thread_placement policy = g_cfg.core.thread_placement_policy;
+
+	LOG_NOTICE(GENERAL, "Host CPU layout: %u threads, %u cores, %u packages, %u NUMA nodes, %u cache domains (CPUs %s)",
+		layout.cpus.size(), layout.cores, layout.packages, layout.nodes, layout.caches, layout.all.to_string());
+
+	if (policy != thread_placement::legacy)
+	{
+		LOG_NOTICE(GENERAL, "Thread placement: NUMA node %u (CPUs %s)", layout.node_id, layout.node.to_string());
+	}
+
+	if (policy == thread_placement::cache)
+	{
+		for (u32 i = 0; i < layout.domains.size(); i++)
+		{
+			LOG_NOTICE(GENERAL, "Thread placement: cache domain %u (CPUs %s) -> %s", i, layout.domains[i].to_string(),
+				i == 0 ? "PPU, RSX" : "SPU groups");
+		}
+	}
+	else
+	{
+		LOG_NOTICE(GENERAL, "Thread placement: PPU (%s), SPU (%s), RSX (%s)",
+			get_affinity_mask(thread_class::ppu).to_string(), get_affinity_mask(thread_class::spu).to_string(), get_affinity_mask(thread_class::rsx).to_string());
+	}
+
+	std::lock_guard lock(s_spu_domain_mutex);
+	s_spu_domains.clear();
+}
+
+// Fixed masks for known CPU layouts (only the first 16 CPUs are used)
+static u16 get_legacy_affinity_mask(native_core_arrangement layout, thread_class group)
+{
 	if (const auto thread_count = std::thread::hardware_concurrency())
 	{
 		const u16 all_cores_mask = thread_count < 16 ? (u16)(~(UINT16_MAX << thread_count)): UINT16_MAX;
 
-		switch (g_native_core_layout)
+		switch (layout)
 		{
 		default:
 		case native_core_arrangement::generic:
@@ -1894,6 +2072,76 @@ u16 thread_ctrl::get_affinity_mask(thread_class group)
 	return UINT16_MAX;
 }
 
+host_cpu_set thread_ctrl::get_affinity_mask(thread_class group, u32 group_id)
+{
+	detect_cpu_layout();
+
+	const auto& layout = get_cpu_layout();
+
+	switch (g_cfg.core.thread_placement_policy)
+	{
+	case thread_placement::legacy:
+	{
+		const u16 mask = get_legacy_affinity_mask(g_native_core_layout, group);
+
+		host_cpu_set result;
+
+		for (u32 i = 0; i < 16; i++)
+		{
+			if (mask & (1u << i))
+			{
+				result.set(i);
+			}
+		}
+
+		return result;
+	}
+	case thread_placement::numa:
+	{
+		return layout.node;
+	}
+	case thread_placement::cache:
+	{
+		// Nothing to group
+		if (layout.domains.size() < 2)
+		{
+			return layout.node;
+		}
+
+		switch (group)
+		{
+		case thread_class::ppu:
+		case thread_class::rsx:
+		{
+			// PPU and RSX communicate through shared memory constantly
+			return layout.domains[0];
+		}
+		case thread_class::spu:
+		{
+			// Distribute SPU thread groups over the remaining domains
+			std::lock_guard lock(s_spu_domain_mutex);
+
+			const auto found = s_spu_domains.emplace(group_id, 0);
+
+			if (found.second)
+			{
+				found.first->second = 1 + (::size32(s_spu_domains) - 1) % (::size32(layout.domains) - 1);
+
+				LOG_NOTICE(GENERAL, "Thread placement: SPU group 0x%x -> cache domain %u (CPUs %s)", group_id, found.first->second, layout.domains[found.first->second].to_string());
+			}
+
+			return layout.domains[found.first->second];
+		}
+		default: break;
+		}
+
+		return layout.node;
+	}
+	}
+
+	return layout.all;
+}
+
 void thread_ctrl::set_native_priority(int priority)
 {
 #ifdef _WIN32
@@ -1927,22 +2175,47 @@ void thread_ctrl::set_native_priority(int priority)
 #endif
 }
 
-void thread_ctrl::set_thread_affinity_mask(u16 mask)
+void thread_ctrl::set_thread_affinity_mask(const host_cpu_set& mask)
 {
+	if (mask.empty())
+	{
+		return;
+	}
+
 #ifdef _WIN32
+	// Only the current processor group is addressable
 	HANDLE _this_thread = GetCurrentThread();
-	SetThreadAffinityMask(_this_thread, (DWORD_PTR)mask);
+	SetThreadAffinityMask(_this_thread, (DWORD_PTR)mask.word(0));
 #elif __APPLE__
-	thread_affinity_policy_data_t policy = { static_cast<integer_t>(mask) };
+	thread_affinity_policy_data_t policy = { static_cast<integer_t>(mask.word(0)) };
 	thread_port_t mach_thread = pthread_mach_thread_np(pthread_self());
 	thread_policy_set(mach_thread, THREAD_AFFINITY_POLICY, (thread_policy_t)&policy, 1);
-#elif defined(__linux__) || defined(__DragonFly__) || defined(__FreeBSD__)
+#elif defined(__linux__)
+	cpu_set_t* cs = CPU_ALLOC(mask.width());
+	const std::size_t size = CPU_ALLOC_SIZE(mask.width());
+	CPU_ZERO_S(size, cs);
+
+	for (u32 core = 0; core < mask.width(); ++core)
+	{
+		if (mask.test(core))
+		{
+			CPU_SET_S(core, size, cs);
+		}
+	}
+
+	if (int err = pthread_setaffinity_np(pthread_self(), size, cs))
+	{
+		LOG_ERROR(GENERAL, "pthread_setaffinity_np() failed: %d (CPUs %s)", err, mask.to_string());
+	}
+
+	CPU_FREE(cs);
+#elif defined(__DragonFly__) || defined(__FreeBSD__)
 	cpu_set_t cs;
 	CPU_ZERO(&cs);
 
-	for (u32 core = 0; core < 16u; ++core)
+	for (u32 core = 0; core < mask.width() && core < CPU_SETSIZE; ++core)
 	{
-		if ((u32)mask & (1u << core))
+		if (mask.test(core))
 		{
 			CPU_SET(core, &cs);
 		}
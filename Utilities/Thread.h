@@ -6,6 +6,7 @@
 #include <string>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 #include "mutex.h"
 #include "cond.h"
@@ -34,6 +35,50 @@ enum class thread_class : u32
 	ppu
 };
 
+// Set of host CPUs (arbitrary width)
+class host_cpu_set
+{
+	std::vector<u64> m_bits;
+
+public:
+	void set(u32 cpu)
+	{
+		if (cpu / 64 >= m_bits.size())
+		{
+			m_bits.resize(cpu / 64 + 1);
+		}
+
+		m_bits[cpu / 64] |= 1ull << (cpu % 64);
+	}
+
+	bool test(u32 cpu) const
+	{
+		return cpu / 64 < m_bits.size() && m_bits[cpu / 64] & (1ull << (cpu % 64));
+	}
+
+	// Get 64 CPUs starting from index * 64
+	u64 word(u32 index) const
+	{
+		return index < m_bits.size() ? m_bits[index] : 0;
+	}
+
+	// Upper bound of the CPU indices
+	u32 width() const
+	{
+		return static_cast<u32>(m_bits.size() * 64);
+	}
+
+	u32 count() const;
+
+	bool empty() const
+	{
+		return count() == 0;
+	}
+
+	// Format as CPU list ("0-3,8-11")
+	std::string to_string() const;
+};
+
 enum class thread_state
 {
 	created,  // Initial state
@@ -257,14 +302,17 @@ public:
 	// Detect layout
 	static void detect_cpu_layout();
 
-	// Returns a core affinity mask. Set whether to generate the high priority set or not
-	static u16 get_affinity_mask(thread_class group);
+	// Report detected layout and reset thread placement (called on boot)
+	static void init_thread_placement();
+
+	// Returns a core affinity set for the thread class (group_id identifies SPU thread group)
+	static host_cpu_set get_affinity_mask(thread_class group, u32 group_id = 0);
 
 	// Sets the native thread priority
 	static void set_native_priority(int priority);
 
 	// Sets the preferred affinity mask for this thread
-	static void set_thread_affinity_mask(u16 mask);
+	static void set_thread_affinity_mask(const host_cpu_set& mask);
 
 	// Spawn a detached named thread
 	template <typename F>
@@ -1,5 +1,10 @@
 #include "sysinfo.h"
 #include "StrFmt.h"
+#include "File.h"
+#include "asm.h"
+
+#include <algorithm>
+#include <thread>
 
 #ifdef _WIN32
 #include "windows.h"
@@ -56,6 +61,12 @@ bool utils::has_xop()
 	return g_value;
 }
 
+bool utils::has_aes()
+{
+	static const bool g_value = get_cpuid(0, 0)[0] >= 0x1 && get_cpuid(1, 0)[2] & 0x2000000;
+	return g_value;
+}
+
 std::string utils::get_system_info()
 {
 	std::string result;
@@ -128,3 +139,240 @@ std::string utils::get_system_info()
 
 	return result;
 }
+
+#ifdef __linux__
+// Read small sysfs file (its reported size is meaningless)
+static std::string read_sysfs(const std::string& path)
+{
+	std::string result;
+
+	if (fs::file f{path})
+	{
+		char buf[4096];
+		result.assign(buf, f.read(buf, sizeof(buf)));
+	}
+
+	return result;
+}
+
+static u32 read_sysfs_u32(const std::string& path)
+{
+	return static_cast<u32>(std::strtoul(read_sysfs(path).c_str(), nullptr, 10));
+}
+
+// Parse sysfs CPU list ("0-3,8,10-11")
+static std::vector<u32> parse_cpu_list(const std::string& str)
+{
+	std::vector<u32> result;
+
+	for (const char* ptr = str.c_str(); *ptr >= '0' && *ptr <= '9';)
+	{
+		char* end;
+		const u32 first = static_cast<u32>(std::strtoul(ptr, &end, 10));
+		u32 last = first;
+
+		if (*end == '-')
+		{
+			last = static_cast<u32>(std::strtoul(end + 1, &end, 10));
+		}
+
+		for (u32 i = first; i <= last; i++)
+		{
+			result.push_back(i);
+		}
+
+		if (*end != ',')
+		{
+			break;
+		}
+
+		ptr = end + 1;
+	}
+
+	return result;
+}
+#endif
+
+std::vector<utils::cpu_topology_entry> utils::get_cpu_topology()
+{
+	std::vector<cpu_topology_entry> result;
+
+	// Cache level which defined the cache domain
+	std::vector<u32> cache_levels;
+
+	const auto find_cpu = [&](u32 id) -> cpu_topology_entry*
+	{
+		for (auto& cpu : result)
+		{
+			if (cpu.id == id)
+			{
+				return &cpu;
+			}
+		}
+
+		return nullptr;
+	};
+
+#ifdef _WIN32
+	// Only the current processor group is reported (up to 64 CPUs)
+	DWORD size = 0;
+	::GetLogicalProcessorInformation(nullptr, &size);
+
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(size / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+
+	if (!info.empty() && ::GetLogicalProcessorInformation(info.data(), &size))
+	{
+		for (const auto& entry : info)
+		{
+			if (entry.Relationship == RelationProcessorCore && entry.ProcessorMask)
+			{
+				const u32 core = static_cast<u32>(utils::cnttz64(entry.ProcessorMask, true));
+
+				for (u32 i = 0; i < 64; i++)
+				{
+					if (entry.ProcessorMask & (1ull << i))
+					{
+						result.push_back({i, core, 0, 0, UINT32_MAX});
+					}
+				}
+			}
+		}
+
+		std::sort(result.begin(), result.end(), [](const cpu_topology_entry& a, const cpu_topology_entry& b) { return a.id < b.id; });
+
+		cache_levels.resize(result.size());
+
+		u32 package = 0;
+
+		for (const auto& entry : info)
+		{
+			if (!entry.ProcessorMask)
+			{
+				continue;
+			}
+
+			const u32 first = static_cast<u32>(utils::cnttz64(entry.ProcessorMask, true));
+
+			for (u32 i = 0; i < 64; i++)
+			{
+				cpu_topology_entry* cpu = entry.ProcessorMask & (1ull << i) ? find_cpu(i) : nullptr;
+
+				if (!cpu)
+				{
+					continue;
+				}
+
+				switch (entry.Relationship)
+				{
+				case RelationNumaNode:
+				{
+					cpu->node = entry.NumaNode.NodeNumber;
+					break;
+				}
+				case RelationProcessorPackage:
+				{
+					cpu->package = package;
+					break;
+				}
+				case RelationCache:
+				{
+					u32& level = cache_levels[cpu - result.data()];
+
+					if (entry.Cache.Type != CacheInstruction && entry.Cache.Level >= level)
+					{
+						level = entry.Cache.Level;
+						cpu->cache = first;
+					}
+
+					break;
+				}
+				default: break;
+				}
+			}
+
+			if (entry.Relationship == RelationProcessorPackage)
+			{
+				package++;
+			}
+		}
+	}
+#elif defined(__linux__)
+	for (u32 id : parse_cpu_list(read_sysfs("/sys/devices/system/cpu/online")))
+	{
+		const std::string path = fmt::format("/sys/devices/system/cpu/cpu%u/", id);
+
+		cpu_topology_entry cpu{id, id, 0, 0, UINT32_MAX};
+
+		const auto siblings = parse_cpu_list(read_sysfs(path + "topology/thread_siblings_list"));
+
+		if (!siblings.empty())
+		{
+			cpu.core = siblings[0];
+		}
+
+		if (fs::is_file(path + "topology/physical_package_id"))
+		{
+			cpu.package = read_sysfs_u32(path + "topology/physical_package_id");
+		}
+
+		// Find the last level data or unified cache
+		u32 level = 0;
+
+		for (u32 index = 0;; index++)
+		{
+			const std::string cache = fmt::format("%scache/index%u/", path, index);
+
+			if (!fs::is_dir(cache))
+			{
+				break;
+			}
+
+			if (read_sysfs(cache + "type").compare(0, 11, "Instruction") == 0)
+			{
+				continue;
+			}
+
+			const auto shared = parse_cpu_list(read_sysfs(cache + "shared_cpu_list"));
+			const u32 _level = read_sysfs_u32(cache + "level");
+
+			if (!shared.empty() && _level >= level)
+			{
+				level = _level;
+				cpu.cache = shared[0];
+			}
+		}
+
+		result.push_back(cpu);
+	}
+
+	for (u32 node : parse_cpu_list(read_sysfs("/sys/devices/system/node/online")))
+	{
+		for (u32 id : parse_cpu_list(read_sysfs(fmt::format("/sys/devices/system/node/node%u/cpulist", node))))
+		{
+			if (auto cpu = find_cpu(id))
+			{
+				cpu->node = node;
+			}
+		}
+	}
+#endif
+
+	if (result.empty())
+	{
+		// Unknown topology: assume independent cores sharing a single cache
+		for (u32 i = 0, count = std::max<u32>(std::thread::hardware_concurrency(), 1); i < count; i++)
+		{
+			result.push_back({i, i, 0, 0, 0});
+		}
+	}
+
+	for (auto& cpu : result)
+	{
+		if (cpu.cache == UINT32_MAX)
+		{
+			cpu.cache = result[0].id;
+		}
+	}
+
+	return result;
+}
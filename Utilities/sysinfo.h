@@ -2,6 +2,7 @@
 
 #include "types.h"
 #include <string>
+#include <vector>
 
 namespace utils
 {
@@ -43,5 +44,20 @@ namespace utils
 
 	bool has_xop();
 
+	bool has_aes();
+
 	std::string get_system_info();
+
+	// Host logical CPU location
+	struct cpu_topology_entry
+	{
+		u32 id; // Logical CPU index
+		u32 core; // Physical core (lowest sibling CPU index)
+		u32 package; // Physical package (socket)
+		u32 node; // NUMA node
+		u32 cache; // Last level cache domain (lowest CPU index sharing it)
+	};
+
+	// Get online host CPUs sorted by index (falls back to a flat layout if unknown)
+	std::vector<cpu_topology_entry> get_cpu_topology();
 }
@@ -30,6 +30,15 @@
  */
 
 #include "aes.h"
+#include "Utilities/sysinfo.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AESNI_FUNC
+#else
+#include <x86intrin.h>
+#define AESNI_FUNC __attribute__((__target__("aes")))
+#endif
 
 /*
  * 32-bit integer manipulation macros (little endian)
@@ -859,6 +868,105 @@ int aes_crypt_ctr( aes_context *ctx,
     return( 0 );
 }
 
+/*
+ * AES-CTR buffer encryption/decryption (whole blocks)
+ */
+static inline uint64_t ctr_bswap64( uint64_t value )
+{
+#ifdef _MSC_VER
+    return _byteswap_uint64( value );
+#else
+    return __builtin_bswap64( value );
+#endif
+}
+
+static AESNI_FUNC void aesni_crypt_ctr_blocks( aes_context *ctx,
+                       size_t blocks,
+                       uint64_t *hi,
+                       uint64_t *lo,
+                       const unsigned char *input,
+                       unsigned char *output )
+{
+    __m128i rk[15];
+    __m128i b[8];
+    int i, j;
+
+    for( i = 0; i <= ctx->nr; i++ )
+        rk[i] = _mm_loadu_si128( (const __m128i*) ( ctx->rk + i * 4 ) );
+
+    while( blocks )
+    {
+        // Process up to 8 independent counter blocks at once to hide aesenc latency
+        const int n = blocks < 8 ? (int) blocks : 8;
+
+        for( j = 0; j < n; j++ )
+        {
+            b[j] = _mm_xor_si128( _mm_set_epi64x( (long long) ctr_bswap64( *lo ), (long long) ctr_bswap64( *hi ) ), rk[0] );
+
+            if( ++*lo == 0 )
+                ++*hi;
+        }
+
+        for( i = 1; i < ctx->nr; i++ )
+            for( j = 0; j < n; j++ )
+                b[j] = _mm_aesenc_si128( b[j], rk[i] );
+
+        for( j = 0; j < n; j++ )
+        {
+            b[j] = _mm_aesenclast_si128( b[j], rk[ctx->nr] );
+            b[j] = _mm_xor_si128( b[j], _mm_loadu_si128( (const __m128i*) input + j ) );
+            _mm_storeu_si128( (__m128i*) output + j, b[j] );
+        }
+
+        input  += 16 * n;
+        output += 16 * n;
+        blocks -= n;
+    }
+}
+
+void aes_crypt_ctr_blocks( aes_context *ctx,
+                       size_t blocks,
+                       unsigned char nonce_counter[16],
+                       const unsigned char *input,
+                       unsigned char *output )
+{
+    uint64_t hi, lo;
+    unsigned char stream_block[16];
+
+    if( utils::has_aes() )
+    {
+        memcpy( &hi, nonce_counter, 8 );
+        memcpy( &lo, nonce_counter + 8, 8 );
+        hi = ctr_bswap64( hi );
+        lo = ctr_bswap64( lo );
+
+        aesni_crypt_ctr_blocks( ctx, blocks, &hi, &lo, input, output );
+
+        hi = ctr_bswap64( hi );
+        lo = ctr_bswap64( lo );
+        memcpy( nonce_counter, &hi, 8 );
+        memcpy( nonce_counter + 8, &lo, 8 );
+        return;
+    }
+
+    while( blocks-- )
+    {
+        int i;
+
+        aes_crypt_ecb( ctx, AES_ENCRYPT, nonce_counter, stream_block );
+
+        for( i = 16; i > 0; i-- )
+            if( ++nonce_counter[i - 1] != 0 )
+                break;
+
+        for( i = 0; i < 16; i++ )
+            output[i] = (unsigned char)( input[i] ^ stream_block[i] );
+
+        input  += 16;
+        output += 16;
+    }
+}
+
 /* AES-CMAC */
 
 unsigned char const_Rb[16] = {
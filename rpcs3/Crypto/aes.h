@@ -172,6 +172,24 @@ int aes_crypt_ctr( aes_context *ctx,
                        const unsigned char *input,
                        unsigned char *output );
 
+/**
+ * \brief          AES-CTR buffer encryption/decryption (whole blocks only)
+ *
+ * The counter is a 128-bit big-endian value incremented after every block.
+ * Uses AES-NI instructions (8 blocks interleaved) if available.
+ *
+ * \param ctx           AES context (initialized with aes_setkey_enc)
+ * \param blocks        The number of 16-byte blocks
+ * \param nonce_counter The 128-bit nonce and counter (updated)
+ * \param input         The input data stream
+ * \param output        The output data stream (can be equal to input)
+ */
+void aes_crypt_ctr_blocks( aes_context *ctx,
+                       size_t blocks,
+                       unsigned char nonce_counter[16],
+                       const unsigned char *input,
+                       unsigned char *output );
+
 void aes_cmac(aes_context *ctx, int length, unsigned char *input, unsigned char *output);
 
 #ifdef __cplusplus
@@ -940,40 +940,154 @@ bool EDATADecrypter::ReadHeader()
 	return true;
 }
 
-u64 EDATADecrypter::ReadData(u64 pos, u8* data, u64 size)
+EDATADecrypter::~EDATADecrypter()
 {
-	if (pos > edatHeader.file_size)
-		return 0;
+	// Stop and join the read-ahead thread
+	prefetch_thread.reset();
 
-	// now we need to offset things to account for the actual 'range' requested
-	const u64 startOffset = pos % edatHeader.block_size;
+	if (cache_hits || cache_misses)
+	{
+		LOG_NOTICE(LOADER, "EDAT: block cache hits: %u, misses: %u (%.1f%%), prefetched: %u, direct: %u", cache_hits, cache_misses, 100. * cache_hits / (cache_hits + cache_misses), cache_prefetched, cache_direct);
+	}
+}
+
+const std::vector<u8>* EDATADecrypter::GetBlock(u32 block, bool prefetch)
+{
+	if (const auto found = cache_map.find(block); found != cache_map.end())
+	{
+		// Mark as most recently used
+		cache.splice(cache.begin(), cache, found->second);
 
-	const u32 num_blocks = static_cast<u32>(std::ceil((startOffset + size) / (double)edatHeader.block_size));
-	const u64 bufSize = num_blocks*edatHeader.block_size;
-	if (data_buf_size < (bufSize))
+		if (!prefetch)
+		{
+			cache_hits++;
+		}
+
+		return &found->second->second;
+	}
+
+	if (cache.size() >= cache_blocks)
+	{
+		// Reuse least recently used entry (and its buffer)
+		cache_map.erase(cache.back().first);
+		cache.splice(cache.begin(), cache, std::prev(cache.end()));
+	}
+	else
 	{
-		data_buf.reset(new u8[bufSize]);
-		data_buf_size = bufSize;
+		cache.emplace_front();
 	}
 
+	auto& entry = cache.front();
+	entry.second.resize(edatHeader.block_size);
+
+	edata_file.seek(0);
+	const s64 res = decrypt_block(&edata_file, entry.second.data(), &edatHeader, &npdHeader, dec_key.data(), block, total_blocks, edatHeader.file_size);
+
+	if (res < 0)
+	{
+		cache.pop_front();
+		return nullptr;
+	}
+
+	entry.first = block;
+	entry.second.resize(res);
+	cache_map.emplace(block, cache.begin());
+
+	if (prefetch)
+	{
+		cache_prefetched++;
+	}
+	else
+	{
+		cache_misses++;
+	}
+
+	return &entry.second;
+}
+
+u64 EDATADecrypter::ReadData(u64 pos, u8* data, u64 size)
+{
+	if (pos > edatHeader.file_size)
+		return 0;
+
 	// find and decrypt block range covering pos + size
 	const u32 starting_block = static_cast<u32>(pos / edatHeader.block_size);
-	const u32 ending_block = std::min(starting_block + num_blocks, total_blocks);
-	u64 writeOffset = 0;
-	for (u32 i = starting_block; i < ending_block; ++i)
+	const u32 ending_block = static_cast<u32>(std::min<u64>((pos + size + edatHeader.block_size - 1) / edatHeader.block_size, total_blocks));
+
+	std::unique_lock lock(cache_mutex);
+
+	// now we need to offset things to account for the actual 'range' requested
+	u64 offset = pos % edatHeader.block_size;
+	u64 bytesWrote = 0;
+
+	for (u32 i = starting_block; i < ending_block && bytesWrote < size; ++i)
 	{
-		edata_file.seek(0);
-		u64 res = decrypt_block(&edata_file, &data_buf[writeOffset], &edatHeader, &npdHeader, dec_key.data(), i, total_blocks, edatHeader.file_size);
-		if (res == -1)
+		// Decrypt whole blocks directly into the destination (large reads bypass the cache)
+		if (offset == 0 && size - bytesWrote >= edatHeader.block_size && cache_map.count(i) == 0)
+		{
+			edata_file.seek(0);
+			const s64 res = decrypt_block(&edata_file, data + bytesWrote, &edatHeader, &npdHeader, dec_key.data(), i, total_blocks, edatHeader.file_size);
+
+			if (res < 0)
+			{
+				LOG_ERROR(LOADER, "Error Decrypting data");
+				return 0;
+			}
+
+			bytesWrote += res;
+			cache_direct++;
+			continue;
+		}
+
+		const auto block = GetBlock(i, false);
+
+		if (!block)
 		{
 			LOG_ERROR(LOADER, "Error Decrypting data");
 			return 0;
 		}
-		writeOffset += res;
+
+		if (offset >= block->size())
+		{
+			break;
+		}
+
+		const u64 count = std::min<u64>(block->size() - offset, size - bytesWrote);
+		memcpy(data + bytesWrote, block->data() + offset, count);
+		bytesWrote += count;
+		offset = 0;
 	}
 
-	const u64 bytesWrote = std::min<u64>(writeOffset - startOffset, size);
+	// Detect sequential access and read ahead
+	if (read_ahead.update(starting_block, ending_block, total_blocks))
+	{
+		if (!prefetch_thread)
+		{
+			prefetch_thread = std::make_unique<named_thread<std::function<void()>>>("EDAT Read-ahead", [this]
+			{
+				while (thread_ctrl::state() != thread_state::aborting)
+				{
+					{
+						std::lock_guard lock(cache_mutex);
+
+						if (u32 block; read_ahead.pop(block))
+						{
+							GetBlock(block, true);
+
+							// Let readers in between blocks
+							continue;
+						}
+					}
+
+					thread_ctrl::wait();
+				}
+			});
+		}
+		else
+		{
+			thread_ctrl::notify(*prefetch_thread);
+		}
+	}
 
-	memcpy(data, &data_buf[startOffset], bytesWrote);
 	return bytesWrote;
 }
@@ -3,8 +3,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <array>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <functional>
 
 #include "utils.h"
+#include "unedat_read_ahead.h"
+#include "Utilities/mutex.h"
+#include "Utilities/Thread.h"
 
 constexpr u32 SDAT_FLAG = 0x01000000;
 constexpr u32 EDAT_COMPRESSED_FLAG = 0x00000001;
@@ -59,9 +66,23 @@ struct EDATADecrypter final : fs::file_base
 	NPD_HEADER npdHeader;
 	EDAT_HEADER edatHeader;
 
-	// Internal data buffers.
-	std::unique_ptr<u8[]> data_buf;
-	u64 data_buf_size{0};
+	// Decrypted block cache (most recently used first) and its index
+	static constexpr u32 cache_blocks = 64;
+	std::list<std::pair<u32, std::vector<u8>>> cache;
+	std::unordered_map<u32, std::list<std::pair<u32, std::vector<u8>>>::iterator> cache_map;
+
+	// Protects the cache and the file stream
+	shared_mutex cache_mutex;
+
+	// Sequential read-ahead (decrypts next blocks in the background)
+	std::unique_ptr<named_thread<std::function<void()>>> prefetch_thread;
+	edat_read_ahead read_ahead;
+
+	// Statistics
+	u64 cache_hits{0};
+	u64 cache_misses{0};
+	u64 cache_prefetched{0};
+	u64 cache_direct{0};
 
 	std::array<u8, 0x10> dec_key{};
 
@@ -76,10 +97,12 @@ public:
 	EDATADecrypter(fs::file&& input, const std::array<u8, 0x10>& dev_key, const std::array<u8, 0x10>& rif_key)
 		: edata_file(std::move(input)), rif_key(rif_key), dev_key(dev_key) {}
 
-	~EDATADecrypter() override {}
+	~EDATADecrypter() override;
 	// false if invalid 
 	bool ReadHeader();
 	u64 ReadData(u64 pos, u8* data, u64 size);
+	// Get decrypted block from the cache or decrypt it (must be called under cache_mutex)
+	const std::vector<u8>* GetBlock(u32 block, bool prefetch);
 
 	fs::stat_t stat() override
 	{
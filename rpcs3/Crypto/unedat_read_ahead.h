@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Utilities/types.h"
+
+#include <algorithm>
+
+// Sequential access detection and read-ahead window of EDATADecrypter (not thread safe)
+struct edat_read_ahead
+{
+	// Max blocks decrypted ahead of the last read
+	static constexpr u32 max_blocks = 8;
+
+	u32 next{0}; // Next block to prefetch
+	u32 end{0}; // End of the prefetch window
+	u32 last_block{UINT32_MAX}; // Last block read (none if UINT32_MAX)
+
+	// Update after reading blocks [first, last), returns true if there are blocks to prefetch
+	bool update(u32 first, u32 last, u32 total_blocks)
+	{
+		if (last <= first)
+		{
+			return false;
+		}
+
+		const bool sequential = last_block != UINT32_MAX && (first == last_block || first == last_block + 1);
+
+		last_block = last - 1;
+
+		if (!sequential)
+		{
+			return false;
+		}
+
+		// Restart the window if it isn't ahead of this read (after a seek), keep progress otherwise
+		if (next < last || next > last + max_blocks)
+		{
+			next = last;
+		}
+
+		end = std::min(last + max_blocks, total_blocks);
+		return next < end;
+	}
+
+	// Get the next block to prefetch, returns false if the window is exhausted
+	bool pop(u32& block)
+	{
+		if (next < end)
+		{
+			block = next++;
+			return true;
+		}
+
+		return false;
+	}
+};
@@ -4,13 +4,71 @@
 #include "sha1.h"
 #include "key_vault.h"
 #include "Utilities/StrFmt.h"
+#include "Utilities/Thread.h"
+#include "Utilities/mutex.h"
+#include "Utilities/cond.h"
 #include "Emu/System.h"
 #include "Emu/VFS.h"
 #include "unpkg.h"
 
+#include <deque>
+
+// Blocking queue connecting the installation pipeline stages
+template <typename T>
+class pkg_queue
+{
+	shared_mutex m_mutex;
+	cond_variable m_cond;
+	std::deque<T> m_queue;
+	bool m_closed = false;
+
+public:
+	void push(T&& value)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_queue.emplace_back(std::move(value));
+		}
+
+		m_cond.notify_all();
+	}
+
+	// Wait for an element (returns false if the queue is closed and empty)
+	bool pop(T& value)
+	{
+		std::unique_lock lock(m_mutex);
+
+		while (m_queue.empty())
+		{
+			if (m_closed)
+			{
+				return false;
+			}
+
+			m_cond.wait(lock);
+		}
+
+		value = std::move(m_queue.front());
+		m_queue.pop_front();
+		return true;
+	}
+
+	// Stop waiting when the queue becomes empty
+	void close()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_closed = true;
+		}
+
+		m_cond.notify_all();
+	}
+};
+
 bool pkg_install(const std::string& path, atomic_t<double>& sync)
 {
 	const std::size_t BUF_SIZE = 8192 * 1024; // 8 MB
+	const std::size_t BUF_COUNT = 4; // Amount of buffers in flight during file extraction
 
 	std::vector<fs::file> filelist;
 	filelist.emplace_back(fs::file{path});
@@ -219,16 +277,11 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 	// Allocate buffer with BUF_SIZE size or more if required
 	const std::unique_ptr<u128[]> buf(new u128[std::max<u64>(BUF_SIZE, sizeof(PKGEntry) * header.file_count) / sizeof(u128)]);
 
-	// Define decryption subfunction (`psp` arg selects the key for specific block)
-	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	// Define in-place decryption subfunction (`offset` selects the stream position, `key` selects the key for specific block)
+	auto decrypt_data = [&](u128* data, u64 offset, u64 size, const uchar* key)
 	{
-		archive_seek(header.data_offset + offset);
-
-		// Read the data and set available size
-		const u64 read = archive_read(buf.get(), size);
-
 		// Get block count
-		const u64 blocks = (read + 15) / 16;
+		const u64 blocks = (size + 15) / 16;
 
 		if (header.pkg_type == PKG_RELEASE_TYPE_DEBUG)
 		{
@@ -251,10 +304,10 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 					u8 data[20];
 					u128 _v128;
 				} hash;
-				
+
 				sha1(reinterpret_cast<const u8*>(input), sizeof(input), hash.data);
 
-				buf[i] ^= hash._v128;
+				data[i] ^= hash._v128;
 			}
 		}
 
@@ -268,16 +321,20 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 			// Initialize stream cipher for start position
 			be_t<u128> input = header.klicensee.value() + offset / 16;
 
-			// Increment stream position for every block
-			for (u64 i = 0; i < blocks; i++, input++)
-			{
-				u128 key;
+			// Counter mode: the counter is incremented for every block
+			aes_crypt_ctr_blocks(&ctx, blocks, reinterpret_cast<uchar*>(&input), reinterpret_cast<const uchar*>(data), reinterpret_cast<uchar*>(data));
+		}
+	};
 
-				aes_crypt_ecb(&ctx, AES_ENCRYPT, reinterpret_cast<const u8*>(&input), reinterpret_cast<u8*>(&key));
+	// Define decryption subfunction for the main buffer
+	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	{
+		archive_seek(header.data_offset + offset);
 
-				buf[i] ^= key;
-			}
-		}
+		// Read the data and set available size
+		const u64 read = archive_read(buf.get(), size);
+
+		decrypt_data(buf.get(), offset, read, key);
 
 		// Return the amount of data written in buf
 		return read;
@@ -306,6 +363,18 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 
 	std::memcpy(entries.data(), buf.get(), entries.size() * sizeof(PKGEntry));
 
+	// Files to extract
+	struct file_info
+	{
+		std::string path;
+		std::string name;
+		const PKGEntry* entry;
+		const uchar* key;
+		bool did_overwrite;
+	};
+
+	std::vector<file_info> files;
+
 	for (const auto& entry : entries)
 	{
 		const bool is_psp = (entry.type & PKG_FILE_ENTRY_PSP) != 0;
@@ -346,53 +415,8 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 				break;
 			}
 
-			if (fs::file out{path, fs::rewrite})
-			{
-				for (u64 pos = 0; pos < entry.file_size; pos += BUF_SIZE)
-				{
-					const u64 block_size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
-
-					if (decrypt(entry.file_offset + pos, block_size, is_psp ? PKG_AES_KEY2 : dec_key.data()) != block_size)
-					{
-						LOG_ERROR(LOADER, "Failed to extract file %s", path);
-						break;
-					}
-
-					if (out.write(buf.get(), block_size) != block_size)
-					{
-						LOG_ERROR(LOADER, "Failed to write file %s", path);
-						break;
-					}
-
-					if (sync.fetch_add((block_size + 0.0) / header.data_size) < 0.)
-					{
-						if (was_null)
-						{
-							LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
-							out.close();
-							fs::remove_all(dir, true);
-							return false;
-						}
-
-						// Cannot cancel the installation
-						sync += 1.;
-					}
-				}
-
-				if (did_overwrite)
-				{
-					LOG_WARNING(LOADER, "Overwritten file %s", name);
-				}
-				else
-				{
-					LOG_NOTICE(LOADER, "Created file %s", name);
-				}
-			}
-			else
-			{
-				LOG_ERROR(LOADER, "Failed to create file %s", path);
-			}
-
+			// Extract later
+			files.push_back({path, name, &entry, is_psp ? PKG_AES_KEY2 : dec_key.data(), did_overwrite});
 			break;
 		}
 
@@ -424,6 +448,155 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 		}
 	}
 
+	// Extract files: reading, decryption and writing (this thread) run in parallel
+	struct chunk
+	{
+		std::size_t file; // Index in files
+		u64 pos;          // Position in file
+		u64 size;         // Requested size
+		u64 read;         // Actually read size
+		std::unique_ptr<u128[]> data;
+	};
+
+	pkg_queue<std::unique_ptr<u128[]>> free_bufs;
+	pkg_queue<chunk> read_chunks;
+	pkg_queue<chunk> dec_chunks;
+	atomic_t<bool> aborted{false};
+
+	for (std::size_t i = 0; i < BUF_COUNT; i++)
+	{
+		free_bufs.push(std::make_unique<u128[]>(BUF_SIZE / sizeof(u128)));
+	}
+
+	named_thread reader("PKG Reader", [&]
+	{
+		for (std::size_t i = 0; i < files.size() && !aborted; i++)
+		{
+			const auto& entry = *files[i].entry;
+
+			// Empty files are still passed as a single empty chunk
+			for (u64 pos = 0; !pos || pos < entry.file_size; pos += BUF_SIZE)
+			{
+				chunk next{i, pos, std::min<u64>(BUF_SIZE, entry.file_size - pos), 0, nullptr};
+
+				if (aborted || !free_bufs.pop(next.data))
+				{
+					break;
+				}
+
+				archive_seek(header.data_offset + entry.file_offset + pos);
+				next.read = archive_read(next.data.get(), next.size);
+				read_chunks.push(std::move(next));
+
+				if (!entry.file_size)
+				{
+					break;
+				}
+			}
+		}
+
+		read_chunks.close();
+	});
+
+	named_thread decrypter("PKG Decrypter", [&]
+	{
+		for (chunk next; read_chunks.pop(next);)
+		{
+			if (!aborted)
+			{
+				decrypt_data(next.data.get(), files[next.file].entry->file_offset + next.pos, next.read, files[next.file].key);
+			}
+
+			dec_chunks.push(std::move(next));
+		}
+
+		dec_chunks.close();
+	});
+
+	fs::file out;
+	std::size_t file_index = -1;
+	bool cur_failed = false;
+
+	auto finish_file = [&]()
+	{
+		if (file_index < files.size() && !cur_failed)
+		{
+			if (files[file_index].did_overwrite)
+			{
+				LOG_WARNING(LOADER, "Overwritten file %s", files[file_index].name);
+			}
+			else
+			{
+				LOG_NOTICE(LOADER, "Created file %s", files[file_index].name);
+			}
+		}
+
+		out.close();
+	};
+
+	for (chunk next; dec_chunks.pop(next); free_bufs.push(std::move(next.data)))
+	{
+		if (next.file != file_index)
+		{
+			finish_file();
+
+			file_index = next.file;
+			cur_failed = !out.open(files[file_index].path, fs::rewrite);
+
+			if (cur_failed)
+			{
+				LOG_ERROR(LOADER, "Failed to create file %s", files[file_index].path);
+			}
+		}
+
+		if (cur_failed)
+		{
+			continue;
+		}
+
+		if (next.read != next.size)
+		{
+			LOG_ERROR(LOADER, "Failed to extract file %s", files[file_index].path);
+			cur_failed = true;
+			continue;
+		}
+
+		if (out.write(next.data.get(), next.size) != next.size)
+		{
+			LOG_ERROR(LOADER, "Failed to write file %s", files[file_index].path);
+			cur_failed = true;
+			continue;
+		}
+
+		if (next.size && sync.fetch_add((next.size + 0.0) / header.data_size) < 0.)
+		{
+			if (was_null)
+			{
+				LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
+				out.close();
+
+				// Stop pipeline threads
+				aborted = true;
+				free_bufs.close();
+
+				for (chunk skip; dec_chunks.pop(skip);)
+				{
+				}
+
+				reader();
+				decrypter();
+
+				fs::remove_all(dir, true);
+				return false;
+			}
+
+			// Cannot cancel the installation
+			sync += 1.;
+		}
+	}
+
+	finish_file();
+
 	LOG_SUCCESS(LOADER, "Package successfully installed to %s", dir);
 	return true;
 }
@@ -6,6 +6,7 @@
 #include "Utilities/GDBDebugServer.h"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/lv2/sys_spu.h"
 
 DECLARE(cpu_thread::g_threads_created){0};
 DECLARE(cpu_thread::g_threads_deleted){0};
@@ -50,7 +51,16 @@ void cpu_thread::operator()()
 
 	if (g_cfg.core.thread_scheduler_enabled)
 	{
-		thread_ctrl::set_thread_affinity_mask(thread_ctrl::get_affinity_mask(id_type() == 1 ? thread_class::ppu : thread_class::spu));
+		if (id_type() == 1)
+		{
+			thread_ctrl::set_thread_affinity_mask(thread_ctrl::get_affinity_mask(thread_class::ppu));
+		}
+		else
+		{
+			// Raw SPU threads share a single placement group (0)
+			const auto group = static_cast<spu_thread*>(this)->group;
+			thread_ctrl::set_thread_affinity_mask(thread_ctrl::get_affinity_mask(thread_class::spu, group ? group->id : 0));
+		}
 	}
 
 	if (g_cfg.core.lower_spu_priority && id_type() == 2)
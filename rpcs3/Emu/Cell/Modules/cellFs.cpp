@@ -5,11 +5,15 @@
 
 #include "Emu/Cell/lv2/sys_fs.h"
 #include "Emu/Cell/lv2/sys_sync.h"
+#include "Emu/Cell/lv2/sys_ppu_thread.h"
+#include "sysPrxForUser.h"
 #include "cellFs.h"
 
 #include "Utilities/StrUtil.h"
+#include "Utilities/cond.h"
 
 #include <mutex>
+#include <deque>
 
 
 
@@ -865,82 +869,244 @@ struct lv2_fs_mount_point
 	std::mutex mutex;
 };
 
-struct fs_aio_thread : ppu_thread
+atomic_t<s32> g_fs_aio_id;
+
+// AIO request
+struct fs_aio_request
 {
-	using ppu_thread::ppu_thread;
+	u32 type; // 1 = read, 2 = write
+	s32 xid;
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
+};
+
+struct fs_aio_manager
+{
+	// Amount of host threads performing file operations
+	static constexpr u32 max_workers = 4;
+
+	// Guest thread executing completion callbacks
+	std::shared_ptr<named_thread<ppu_thread>> thread;
+
+	// Number of cellFsAioInit calls not matched by cellFsAioFinish
+	u32 init_count = 0;
+
+	// Serializes cellFsAioInit and cellFsAioFinish (protects workers)
+	shared_mutex init_mutex;
+
+	// Protects all members except workers
+	shared_mutex mutex;
+	cond_variable cond;
+	std::deque<fs_aio_request> queue;
+	bool closed = true;
+
+	std::vector<std::unique_ptr<named_thread<std::function<void()>>>> workers;
+
+	fs_aio_manager() = default;
+
+	fs_aio_manager(const fs_aio_manager&) = delete;
+
+	~fs_aio_manager()
+	{
+		stop();
+	}
+
+	void start()
+	{
+		for (u32 i = 0; i < max_workers; i++)
+		{
+			workers.emplace_back(std::make_unique<named_thread<std::function<void()>>>(fmt::format("FS AIO Worker %u", i), [this]
+			{
+				for (fs_aio_request req; pop(req);)
+				{
+					process(req);
+				}
+			}));
+		}
+	}
 
-	void non_task()
+	// Finish pending requests
+	void stop()
 	{
-		while (cmd64 cmd = cmd_wait())
 		{
-			const u32 type = cmd.arg1<u32>();
-			const s32 xid = cmd.arg2<s32>();
-			const cmd64 cmd2 = cmd_get(1);
-			const auto aio = cmd2.arg1<vm::ptr<CellFsAio>>();
-			const auto func = cmd2.arg2<fs_aio_cb_t>();
-			cmd_pop(1);
+			std::lock_guard lock(mutex);
+			closed = true;
+		}
 
-			s32 error = CELL_OK;
-			u64 result = 0;
+		cond.notify_all();
 
-			const auto file = idm::get<lv2_fs_object, lv2_file>(aio->fd);
+		// Join host threads
+		workers.clear();
+	}
+
+	// Add request (returns false if not initialized or finished)
+	bool push(u32 type, vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+	{
+		{
+			std::lock_guard lock(mutex);
 
-			if (!file || (type == 1 && file->flags & CELL_FS_O_WRONLY) || (type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+			if (closed || !thread)
 			{
-				error = CELL_EBADF;
+				return false;
 			}
-			else
+
+			const s32 xid = (*id = ++g_fs_aio_id);
+			queue.push_back({type, xid, aio, func});
+		}
+
+		cond.notify_one();
+		return true;
+	}
+
+	// Wait for a request (returns false if the queue is closed and empty)
+	bool pop(fs_aio_request& req)
+	{
+		std::unique_lock lock(mutex);
+
+		while (queue.empty())
+		{
+			if (closed)
 			{
-				std::lock_guard lock(file->mp->mutex);
+				return false;
+			}
 
-				const auto old_pos = file->file.pos(); file->file.seek(aio->offset);
+			cond.wait(lock);
+		}
 
-				result = type == 2
-					? file->op_write(aio->buf, aio->size)
-					: file->op_read(aio->buf, aio->size);
+		req = queue.front();
+		queue.pop_front();
+		return true;
+	}
 
-				file->file.seek(old_pos);
+	// Remove request which hasn't been started yet
+	bool cancel(s32 xid, fs_aio_request& req)
+	{
+		std::lock_guard lock(mutex);
+
+		if (!thread)
+		{
+			return false;
+		}
+
+		for (auto it = queue.begin(); it != queue.end(); it++)
+		{
+			if (it->xid == xid)
+			{
+				req = *it;
+				queue.erase(it);
+				return true;
 			}
+		}
+
+		return false;
+	}
+
+	void process(const fs_aio_request& req)
+	{
+		s32 error = CELL_OK;
+		u64 result = 0;
 
-			func(*this, aio, error, xid, result);
-			lv2_obj::sleep(*this);
+		const auto file = idm::get<lv2_fs_object, lv2_file>(req.aio->fd);
+
+		if (!file || (req.type == 1 && file->flags & CELL_FS_O_WRONLY) || (req.type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+		{
+			error = CELL_EBADF;
 		}
+		else
+		{
+			// Only lock the file (requests for other files on this mount point proceed in parallel)
+			std::lock_guard lock(file->mutex);
+
+			const auto old_pos = file->file.pos(); file->file.seek(req.aio->offset);
+
+			result = req.type == 2
+				? file->op_write(req.aio->buf, req.aio->size)
+				: file->op_read(req.aio->buf, req.aio->size);
+
+			file->file.seek(old_pos);
+		}
+
+		complete(req, error, result);
 	}
-};
 
-struct fs_aio_manager
-{
-	std::shared_ptr<fs_aio_thread> thread;
+	// Execute callback on the guest thread
+	void complete(const fs_aio_request& req, s32 error, u64 result)
+	{
+		if (!req.func)
+		{
+			return;
+		}
+
+		std::shared_ptr<named_thread<ppu_thread>> ppu;
+		{
+			reader_lock lock(mutex);
+			ppu = thread;
+		}
+
+		if (!ppu)
+		{
+			return;
+		}
+
+		ppu->cmd_list
+		({
+			{ ppu_cmd::reset_stack, 0 },
+			{ ppu_cmd::set_args, 4 }, u64{req.aio.addr()}, u64{static_cast<u32>(error)}, u64{static_cast<u32>(req.xid)}, result,
+			{ ppu_cmd::lle_call, req.func.addr() },
+			{ ppu_cmd::sleep, 0 }
+		});
+
+		thread_ctrl::notify(*ppu);
+	}
 };
 
-s32 cellFsAioInit(vm::cptr<char> mount_point)
+s32 cellFsAioInit(ppu_thread& ppu, vm::cptr<char> mount_point)
 {
 	cellFs.warning("cellFsAioInit(mount_point=%s)", mount_point);
 
-	// TODO: create AIO thread (if not exists) for specified mount point
-	const auto m = fxm::make<fs_aio_manager>();
+	// TODO: create AIO thread for every mount point
+	const auto m = fxm::get_always<fs_aio_manager>();
 
-	fmt::throw_exception("cellFsAio disabled, use LLE.");
+	std::lock_guard init_lock(m->init_mutex);
 
-	return CELL_OK;
-}
+	{
+		std::lock_guard lock(m->mutex);
 
-s32 cellFsAioFinish(vm::cptr<char> mount_point)
-{
-	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
+		if (m->init_count++)
+		{
+			return CELL_OK;
+		}
+	}
+
+	// Create callback thread (interrupt thread model: commands are executed on demand)
+	vm::var<u64> _tid;
+	vm::var<char[]> _name = vm::make_str("_cellFsAio");
+
+	if (error_code res = ppu_execute<&sys_ppu_thread_create>(ppu, +_tid, 0, 0, 1000, 0x4000, SYS_PPU_THREAD_CREATE_INTERRUPT, +_name))
+	{
+		std::lock_guard lock(m->mutex);
+		m->init_count--;
+		return res;
+	}
+
+	const auto thrd = idm::get<named_thread<ppu_thread>>(static_cast<u32>(*_tid));
+	thrd->state -= cpu_flag::stop;
+	thread_ctrl::notify(*thrd);
+
+	{
+		std::lock_guard lock(m->mutex);
+		m->thread = thrd;
+		m->closed = false;
+	}
 
-	// TODO: delete existing AIO thread for specified mount point
+	m->start();
 
 	return CELL_OK;
 }
 
-atomic_t<s32> g_fs_aio_id;
-
-s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+s32 cellFsAioFinish(ppu_thread& ppu, vm::cptr<char> mount_point)
 {
-	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
-
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
 
 	const auto m = fxm::get<fs_aio_manager>();
 
@@ -949,48 +1115,100 @@ s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 		return CELL_ENXIO;
 	}
 
-	const s32 xid = (*id = ++g_fs_aio_id);
+	// Workers and the callback thread are joined below
+	lv2_obj::sleep(ppu);
+
+	std::lock_guard init_lock(m->init_mutex);
+
+	{
+		std::lock_guard lock(m->mutex);
+
+		if (!m->init_count || --m->init_count)
+		{
+			return CELL_OK;
+		}
+	}
+
+	// Complete pending requests
+	m->stop();
+
+	std::shared_ptr<named_thread<ppu_thread>> thrd;
+	{
+		std::lock_guard lock(m->mutex);
+		thrd = std::move(m->thread);
+	}
 
-	m->thread->cmd_list
+	const u32 tid = thrd->id;
+
+	// Let the callback thread exit after the pending callbacks
+	thrd->cmd_list
 	({
-		{ 1, xid },
-		{ aio, func },
+		{ ppu_cmd::ptr_call, 0 }, +[](ppu_thread& cb_thread) -> bool
+		{
+			cb_thread.state += cpu_flag::exit;
+			return false;
+		}
 	});
 
+	thread_ctrl::notify(*thrd);
+	thrd.reset();
+
+	// Wait for the callback thread and destroy it
+	ppu_execute<&sys_interrupt_thread_disestablish>(ppu, tid);
 	return CELL_OK;
 }
 
-s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+static s32 fs_aio_submit(u32 type, vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 {
-	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
-
 	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
 
 	const auto m = fxm::get<fs_aio_manager>();
 
-	if (!m)
+	if (!m || !m->push(type, aio, id, func))
 	{
 		return CELL_ENXIO;
 	}
 
-	const s32 xid = (*id = ++g_fs_aio_id);
+	return CELL_OK;
+}
 
-	m->thread->cmd_list
-	({
-		{ 2, xid },
-		{ aio, func },
-	});
+s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
 
-	return CELL_OK;
+	return fs_aio_submit(1, aio, id, func);
+}
+
+s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+
+	return fs_aio_submit(2, aio, id, func);
 }
 
 s32 cellFsAioCancel(s32 id)
 {
-	cellFs.todo("cellFsAioCancel(id=%d) -> CELL_EINVAL", id);
+	cellFs.warning("cellFsAioCancel(id=%d)", id);
 
-	// TODO: cancelled requests return CELL_ECANCELED through their own callbacks
+	const auto m = fxm::get<fs_aio_manager>();
 
-	return CELL_EINVAL;
+	if (!m)
+	{
+		return CELL_EINVAL;
+	}
+
+	fs_aio_request req;
+
+	// Requests which are already being processed can't be cancelled
+	if (!m->cancel(id, req))
+	{
+		return CELL_EINVAL;
+	}
+
+	// Cancelled requests return CELL_ECANCELED through their own callbacks
+	m->complete(req, CELL_ECANCELED, 0);
+
+	return CELL_OK;
 }
 
 s32 cellFsArcadeHddSerialNumber()
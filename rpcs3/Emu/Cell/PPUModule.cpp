@@ -16,6 +16,7 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <thread>
 
 
 
@@ -706,7 +707,8 @@ static auto ppu_load_imports(std::vector<ppu_reloc>& relocs, const std::shared_p
 	return result;
 }
 
-std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::string& path)
+// If analyse_toc is set, analysis is skipped and the TOC is returned for later ppu_module::analyse() call
+static std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::string& path, u32* analyse_toc)
 {
 	// Create new PRX object
 	const auto prx = idm::make_ptr<lv2_obj, lv2_prx>();
@@ -943,7 +945,15 @@ std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::stri
 		prx->specials = ppu_load_exports(link, lib_info->exports_start, lib_info->exports_end);
 		prx->imports = ppu_load_imports(prx->relocs, link, lib_info->imports_start, lib_info->imports_end);
 		std::stable_sort(prx->relocs.begin(), prx->relocs.end());
-		prx->analyse(lib_info->toc, 0);
+
+		if (analyse_toc)
+		{
+			*analyse_toc = lib_info->toc;
+		}
+		else
+		{
+			prx->analyse(lib_info->toc, 0);
+		}
 	}
 	else
 	{
@@ -995,6 +1005,11 @@ std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::stri
 	return prx;
 }
 
+std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::string& path)
+{
+	return ppu_load_prx(elf, path, nullptr);
+}
+
 void ppu_unload_prx(const lv2_prx& prx)
 {
 	// Clean linkage info
@@ -1397,32 +1412,83 @@ void ppu_load_exec(const ppu_exec_object& elf)
 				"\nVisit https://rpcs3.net/ for Quickstart Guide and more information.");
 		}
 
-		for (const auto& name : load_libs)
-		{
-			const ppu_prx_object obj = decrypt_self(fs::file(lle_dir + name));
+		const std::vector<std::string> names(load_libs.begin(), load_libs.end());
 
-			if (obj == elf_error::ok)
-			{
-				LOG_WARNING(LOADER, "Loading library: %s", name);
+		std::vector<ppu_prx_object> objs(names.size());
+		std::vector<std::shared_ptr<lv2_prx>> prxs(names.size());
+		std::vector<u32> tocs(names.size());
 
-				auto prx = ppu_load_prx(obj, lle_dir + name);
+		// Run func(i) for every library on all available cores
+		auto run_parallel = [&](const std::function<void(std::size_t)>& func)
+		{
+			atomic_t<std::size_t> next{0};
 
-				if (prx->funcs.empty())
-				{
-					LOG_FATAL(LOADER, "Module %s has no functions!", name);
-				}
-				else
+			auto work = [&]
+			{
+				for (std::size_t i; (i = next++) < names.size();)
 				{
-					// TODO: fix arguments
-					prx->validate(prx->funcs[0].addr);
+					func(i);
 				}
+			};
 
-				loaded_modules.emplace_back(std::move(prx));
+			const u32 count = std::min<u32>(std::max<u32>(std::thread::hardware_concurrency(), 1), ::size32(names));
+
+			std::vector<std::unique_ptr<named_thread<std::function<void()>>>> workers;
+
+			for (u32 i = 1; i < count; i++)
+			{
+				workers.emplace_back(std::make_unique<named_thread<std::function<void()>>>(fmt::format("PRX Loader %u", i), work));
+			}
+
+			work();
+
+			for (auto& worker : workers)
+			{
+				(*worker)();
+			}
+		};
+
+		// Decrypt and parse libraries (independent)
+		run_parallel([&](std::size_t i)
+		{
+			objs[i] = decrypt_self(fs::file(lle_dir + names[i]));
+		});
+
+		// Map, relocate and link libraries in deterministic order
+		for (std::size_t i = 0; i < names.size(); i++)
+		{
+			if (objs[i] != elf_error::ok)
+			{
+				fmt::throw_exception("Failed to load /dev_flash/sys/external/%s: %s", names[i], objs[i].get_error());
+			}
+
+			LOG_WARNING(LOADER, "Loading library: %s", names[i]);
+
+			prxs[i] = ppu_load_prx(objs[i], lle_dir + names[i], &tocs[i]);
+
+			// Release decrypted data
+			objs[i] = {};
+		}
+
+		// Analyse libraries (independent)
+		run_parallel([&](std::size_t i)
+		{
+			prxs[i]->analyse(tocs[i], 0);
+
+			if (prxs[i]->funcs.empty())
+			{
+				LOG_FATAL(LOADER, "Module %s has no functions!", names[i]);
 			}
 			else
 			{
-				fmt::throw_exception("Failed to load /dev_flash/sys/external/%s: %s", name, obj.get_error());
+				// TODO: fix arguments
+				prxs[i]->validate(prxs[i]->funcs[0].addr);
 			}
+		});
+
+		for (auto& prx : prxs)
+		{
+			loaded_modules.emplace_back(std::move(prx));
 		}
 	}
 
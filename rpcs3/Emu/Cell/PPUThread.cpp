@@ -1,4 +1,4 @@
-#include "stdafx.h"
+﻿#include "stdafx.h"
 #include "Utilities/VirtualMemory.h"
 #include "Utilities/sysinfo.h"
 #include "Utilities/JIT.h"
@@ -186,6 +186,259 @@ static u32 ppu_cache(u32 addr)
 	return ::narrow<u32>(reinterpret_cast<std::uintptr_t>(table[ppu_decode(vm::read32(addr))]));
 }
 
+// Superinstruction (the first instruction never branches)
+template <ppu_inter_func_t F1, ppu_inter_func_t F2>
+static bool ppu_fused(ppu_thread& ppu, ppu_opcode_t op1, ppu_opcode_t op2)
+{
+	F1(ppu, op1);
+	ppu.cia += 4;
+	return F2(ppu, op2);
+}
+
+using ppu_fused_func_t = bool(*)(ppu_thread&, ppu_opcode_t, ppu_opcode_t);
+
+// Common instruction pairs executed as superinstructions
+static const struct
+{
+	ppu_inter_func_t first;
+	ppu_inter_func_t second;
+	ppu_fused_func_t fused;
+}
+s_ppu_fused_table[]
+{
+#define FUSE(x, y) {&ppu_interpreter::x, &ppu_interpreter::y, &ppu_fused<&ppu_interpreter::x, &ppu_interpreter::y>}
+	FUSE(CMPI, BC),
+	FUSE(CMPLI, BC),
+	FUSE(CMP, BC),
+	FUSE(CMPL, BC),
+	FUSE(RLWINM, BC),
+	FUSE(RLWINM, LWZX),
+	FUSE(RLWINM, LWZ),
+#undef FUSE
+};
+
+// Predecoded instruction (or two instructions if fused is set)
+struct ppu_block_op
+{
+	ppu_inter_func_t func;
+	ppu_fused_func_t fused;
+	ppu_opcode_t op;
+	ppu_opcode_t op2;
+};
+
+// Number of allocated predecoded blocks (statistics)
+static atomic_t<u32> s_ppu_block_count{0};
+
+// Predecoded straight-line code, ends with a branch or before any special function
+struct ppu_block
+{
+	std::vector<ppu_block_op> ops;
+
+	// Original instructions (as in memory), compared on every entry to detect code modification
+	std::vector<u32> code;
+
+	// Cleared on invalidation
+	atomic_t<bool> valid{true};
+
+	ppu_block()
+	{
+		s_ppu_block_count++;
+	}
+
+	~ppu_block()
+	{
+		s_ppu_block_count--;
+	}
+};
+
+// Incremented on every cache creation (0 is never valid)
+static atomic_t<u32> s_ppu_block_gen{0};
+
+// Predecoded block storage for the fast interpreter
+class ppu_block_cache
+{
+	shared_mutex m_mutex;
+
+	// Invalidated blocks are erased, threads executing them keep them alive in their lookup slots
+	std::unordered_map<u32, std::shared_ptr<ppu_block>> m_map;
+
+	// Incremented on every invalidation
+	atomic_t<u64> m_version{0};
+
+	// Statistics
+	atomic_t<u64> m_built{0};
+	atomic_t<u64> m_invalidated{0};
+	atomic_t<u32> m_peak{0};
+
+	std::shared_ptr<ppu_block> build(u32 addr);
+
+public:
+	ppu_block_cache()
+	{
+		s_ppu_block_gen++;
+	}
+
+	~ppu_block_cache()
+	{
+		LOG_NOTICE(PPU, "Predecoded blocks: %u built, %u invalidated, %u allocated at most, %u still allocated",
+			m_built.load(), m_invalidated.load(), m_peak.load(), s_ppu_block_count.load());
+	}
+
+	std::shared_ptr<ppu_block> get(u32 addr);
+
+	// Remove blocks containing any instruction in the range
+	void invalidate(u32 addr, u32 size);
+};
+
+std::shared_ptr<ppu_block> ppu_block_cache::build(u32 addr)
+{
+	auto block = std::make_shared<ppu_block>();
+
+	m_built++;
+	m_peak.atomic_op([](u32& peak)
+	{
+		peak = std::max<u32>(peak, s_ppu_block_count);
+	});
+
+	const auto& table = g_ppu_interpreter_fast.get_table();
+
+	// Limit block size and don't cross page boundary
+	for (u32 pos = addr; pos / 4096 == addr / 4096 && block->ops.size() < 32; pos += 4)
+	{
+		const ppu_opcode_t op{vm::read32(pos)};
+		const auto func = table[ppu_decode(op.opcode)];
+
+		// Stop at breakpoints, unregistered and HLE functions
+		if (ppu_ref(pos) != ::narrow<u32>(reinterpret_cast<std::uintptr_t>(func)))
+		{
+			break;
+		}
+
+		block->code.push_back(*vm::_ptr<const u32>(pos));
+
+		bool fused = false;
+
+		if (!block->ops.empty() && !block->ops.back().fused)
+		{
+			auto& prev = block->ops.back();
+
+			for (const auto& pair : s_ppu_fused_table)
+			{
+				if (prev.func == pair.first && func == pair.second)
+				{
+					prev.fused = pair.fused;
+					prev.op2 = op;
+					fused = true;
+					break;
+				}
+			}
+		}
+
+		if (!fused)
+		{
+			block->ops.push_back({func, nullptr, op, {}});
+		}
+
+		if (func == &ppu_interpreter::B || func == &ppu_interpreter::BC || func == &ppu_interpreter::BCLR || func == &ppu_interpreter::BCCTR || func == &ppu_interpreter::SC)
+		{
+			break;
+		}
+	}
+
+	return block;
+}
+
+std::shared_ptr<ppu_block> ppu_block_cache::get(u32 addr)
+{
+	{
+		reader_lock lock(m_mutex);
+
+		const auto found = m_map.find(addr);
+
+		if (found != m_map.end())
+		{
+			return found->second;
+		}
+	}
+
+	const u64 version = m_version;
+
+	auto block = build(addr);
+
+	std::lock_guard lock(m_mutex);
+
+	if (version != m_version)
+	{
+		// Invalidated during decoding, don't keep it (executed once)
+		block->valid = false;
+		return block;
+	}
+
+	auto& ptr = m_map[addr];
+
+	if (!ptr)
+	{
+		ptr = std::move(block);
+	}
+
+	return ptr;
+}
+
+void ppu_block_cache::invalidate(u32 addr, u32 size)
+{
+	std::lock_guard lock(m_mutex);
+
+	m_version++;
+
+	// Blocks don't cross page boundary and don't exceed 32 instructions
+	const u32 start = addr - std::min<u32>(addr % 4096, 31 * 4);
+	const u64 end = u64{addr} + size;
+
+	const auto retire = [&](auto it)
+	{
+		// Thread-local lookups check this flag
+		it->second->valid = false;
+		m_invalidated++;
+		return m_map.erase(it);
+	};
+
+	if (end - start <= 1024)
+	{
+		for (u64 pos = start; pos < end; pos += 4)
+		{
+			const auto found = m_map.find(static_cast<u32>(pos));
+
+			if (found != m_map.end())
+			{
+				retire(found);
+			}
+		}
+
+		return;
+	}
+
+	for (auto it = m_map.begin(); it != m_map.end();)
+	{
+		if (it->first >= start && it->first < end)
+		{
+			it = retire(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+}
+
+// Invalidate predecoded blocks after modifying the executable cache
+static void ppu_invalidate_blocks(u32 addr, u32 size = 4)
+{
+	if (const auto cache = fxm::get<ppu_block_cache>())
+	{
+		cache->invalidate(addr, size);
+	}
+}
+
 static bool ppu_fallback(ppu_thread& ppu, ppu_opcode_t op)
 {
 	if (g_cfg.core.ppu_decoder == ppu_decoder_type::llvm)
@@ -194,6 +447,7 @@ static bool ppu_fallback(ppu_thread& ppu, ppu_opcode_t op)
 	}
 
 	ppu_ref(ppu.cia) = ppu_cache(ppu.cia);
+	ppu_invalidate_blocks(ppu.cia);
 
 	if (g_cfg.core.ppu_debug)
 	{
@@ -243,12 +497,12 @@ extern void ppu_register_range(u32 addr, u32 size)
 	const u32 fallback = ::narrow<u32>(reinterpret_cast<std::uintptr_t>(ppu_fallback));
 
 	size &= ~3; // Loop assumes `size = n * 4`, enforce that by rounding down
-	while (size)
+	for (u32 i = 0; i < size; i += 4)
 	{
-		ppu_ref(addr) = fallback;
-		addr += 4;
-		size -= 4;
+		ppu_ref(addr + i) = fallback;
 	}
+
+	ppu_invalidate_blocks(addr, size);
 }
 
 extern void ppu_register_function_at(u32 addr, u32 size, ppu_function_t ptr)
@@ -257,6 +511,7 @@ extern void ppu_register_function_at(u32 addr, u32 size, ppu_function_t ptr)
 	if (ptr)
 	{
 		ppu_ref(addr) = ::narrow<u32>(reinterpret_cast<std::uintptr_t>(ptr));
+		ppu_invalidate_blocks(addr);
 		return;
 	}
 
@@ -278,16 +533,15 @@ extern void ppu_register_function_at(u32 addr, u32 size, ppu_function_t ptr)
 	// Initialize interpreter cache
 	const u32 fallback = ::narrow<u32>(reinterpret_cast<std::uintptr_t>(ppu_fallback));
 
-	while (size)
+	for (u32 i = 0; i < size; i += 4)
 	{
-		if (ppu_ref(addr) == fallback)
+		if (ppu_ref(addr + i) == fallback)
 		{
-			ppu_ref(addr) = ppu_cache(addr);
+			ppu_ref(addr + i) = ppu_cache(addr + i);
 		}
-
-		addr += 4;
-		size -= 4;
 	}
+
+	ppu_invalidate_blocks(addr, size);
 }
 
 // Breakpoint entry point
@@ -332,6 +586,8 @@ extern void ppu_breakpoint(u32 addr, bool isAdding)
 		// Remove breakpoint
 		ppu_ref(addr) = ppu_cache(addr);
 	}
+
+	ppu_invalidate_blocks(addr);
 }
 
 //sets breakpoint, does nothing if there is a breakpoint there already
@@ -347,6 +603,7 @@ extern void ppu_set_breakpoint(u32 addr)
 	if (ppu_ref(addr) != _break)
 	{
 		ppu_ref(addr) = _break;
+		ppu_invalidate_blocks(addr);
 	}
 }
 
@@ -363,6 +620,7 @@ extern void ppu_remove_breakpoint(u32 addr)
 	if (ppu_ref(addr) == _break)
 	{
 		ppu_ref(addr) = ppu_cache(addr);
+		ppu_invalidate_blocks(addr);
 	}
 }
 
@@ -393,6 +651,8 @@ extern bool ppu_patch(u32 addr, u32 value)
 		ppu_ref(addr) = ppu_cache(addr);
 	}
 
+	// Opcode may be predecoded in a block even if the function is unchanged
+	ppu_invalidate_blocks(addr);
 	return true;
 }
 
@@ -477,6 +737,7 @@ std::string ppu_thread::dump() const
 }
 
 extern thread_local std::string(*g_tls_log_prefix)();
+extern thread_local logs::raw_prefix(*g_tls_log_raw_prefix)();
 
 void ppu_thread::cpu_task()
 {
@@ -596,6 +857,11 @@ void ppu_thread::exec_task()
 		return;
 	}
 
+	if (g_cfg.core.ppu_decoder == ppu_decoder_type::fast)
+	{
+		return exec_blocks();
+	}
+
 	const auto base = vm::_ptr<const u8>(0);
 	const auto cache = vm::g_exec_addr;
 	const auto bswap4 = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
@@ -676,6 +942,77 @@ void ppu_thread::exec_task()
 	}
 }
 
+void ppu_thread::exec_blocks()
+{
+	const auto base = vm::_ptr<const u8>(0);
+	const auto blocks = fxm::get_always<ppu_block_cache>();
+
+	using func_t = decltype(&ppu_interpreter::UNK);
+
+	// Recently used blocks (direct-mapped), keep invalidated blocks alive until replaced
+	struct block_slot
+	{
+		u32 addr;
+		u32 gen;
+		std::shared_ptr<const ppu_block> block;
+	};
+
+	static thread_local std::array<block_slot, 1024> s_tls_blocks{};
+
+	while (true)
+	{
+		if (UNLIKELY(state))
+		{
+			if (check_state()) return;
+
+			// Decode single instruction (may be step)
+			const u32 op = *reinterpret_cast<const be_t<u32>*>(base + cia);
+			if (reinterpret_cast<func_t>((std::uintptr_t)ppu_ref(cia))(*this, {op})) { cia += 4; }
+			continue;
+		}
+
+		auto& slot = s_tls_blocks[cia / 4 % s_tls_blocks.size()];
+
+		const u32 gen = s_ppu_block_gen;
+
+		if (UNLIKELY(slot.addr != cia || slot.gen != gen || !slot.block->valid))
+		{
+			slot.addr = cia;
+			slot.gen = gen;
+			slot.block = blocks->get(cia);
+		}
+
+		const auto& code = slot.block->code;
+
+		if (UNLIKELY(std::memcmp(base + cia, code.data(), code.size() * sizeof(u32)) != 0))
+		{
+			// Code modified (block is rebuilt on the next iteration)
+			blocks->invalidate(cia, 4);
+			continue;
+		}
+
+		const auto& ops = slot.block->ops;
+
+		if (UNLIKELY(ops.empty()))
+		{
+			// Special function
+			const u32 op = *reinterpret_cast<const be_t<u32>*>(base + cia);
+			if (reinterpret_cast<func_t>((std::uintptr_t)ppu_ref(cia))(*this, {op})) { cia += 4; }
+			continue;
+		}
+
+		for (const auto& op : ops)
+		{
+			if (op.fused ? !op.fused(*this, op.op, op.op2) : !op.func(*this, op.op))
+			{
+				break;
+			}
+
+			cia += 4;
+		}
+	}
+}
+
 ppu_thread::~ppu_thread()
 {
 	// Deallocate Stack Area
@@ -792,6 +1129,7 @@ void ppu_thread::fast_call(u32 addr, u32 rtoc)
 	const auto old_lr = lr;
 	const auto old_func = last_function;
 	const auto old_fmt = g_tls_log_prefix;
+	const auto old_raw_fmt = g_tls_log_raw_prefix;
 
 	cia = addr;
 	gpr[2] = rtoc;
@@ -804,6 +1142,12 @@ void ppu_thread::fast_call(u32 addr, u32 rtoc)
 		return fmt::format("%s [0x%08x]", thread_ctrl::get_name(), _this->cia);
 	};
 
+	g_tls_log_raw_prefix = []
+	{
+		const auto _this = static_cast<ppu_thread*>(get_current_cpu_thread());
+		return logs::raw_prefix{thread_ctrl::get_name(), _this->cia, 8};
+	};
+
 	auto at_ret = gsl::finally([&]()
 	{
 		if (std::uncaught_exceptions())
@@ -830,6 +1174,7 @@ void ppu_thread::fast_call(u32 addr, u32 rtoc)
 			lr = old_lr;
 			last_function = old_func;
 			g_tls_log_prefix = old_fmt;
+			g_tls_log_raw_prefix = old_raw_fmt;
 		}
 	});
 
@@ -1266,6 +1611,275 @@ extern void ppu_initialize()
 	spu_cache::initialize();
 }
 
+#ifdef LLVM_AVAILABLE
+// Module part compiled in background (PPU Async Compilation)
+struct ppu_async_part
+{
+	ppu_module part;
+	std::string obj_name;
+	std::string cache_path;
+
+	// Global variables to initialize after linkage
+	std::vector<std::pair<std::string, u64>> globals;
+
+	// Interpreter stubs of the whole module (symbol -> address)
+	std::shared_ptr<const std::unordered_map<std::string, u64>> stubs;
+
+	// Guest address range
+	u32 start;
+	u32 end;
+
+	// Number of interpreted function entries
+	atomic_t<u64> hits{0};
+};
+
+// Stub memory ranges (lock-free access from the interpreter)
+static std::array<std::pair<u64, u64>, 256> s_ppu_stub_ranges{};
+static atomic_t<u32> s_ppu_stub_count{0};
+
+// Background compilation state
+struct ppu_async_compiler
+{
+	shared_mutex mutex;
+
+	// Parts which are not compiled yet
+	std::vector<std::shared_ptr<ppu_async_part>> queue;
+
+	// Parts which are not linked yet (start address -> part)
+	std::map<u32, std::shared_ptr<ppu_async_part>> parts;
+
+	const std::unordered_map<std::string, u64>& link_table;
+
+	// Compilation threads (destroyed first)
+	std::vector<std::unique_ptr<named_thread<std::function<void()>>>> workers;
+
+	ppu_async_compiler(const std::unordered_map<std::string, u64>& link)
+		: link_table(link)
+	{
+		// Forget stubs of the previous run
+		s_ppu_stub_count = 0;
+	}
+};
+
+static bool ppu_async_is_stub(u32 ref)
+{
+	for (u32 i = 0, count = s_ppu_stub_count; i < count; i++)
+	{
+		if (ref >= s_ppu_stub_ranges[i].first && ref < s_ppu_stub_ranges[i].second)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Execute not compiled function in the interpreter, return when compiled code is available
+static bool ppu_async_interpreter(ppu_thread& ppu)
+{
+	const auto& table = g_ppu_interpreter_fast.get_table();
+	const u32 fallback = ::narrow<u32>(reinterpret_cast<std::uintptr_t>(&ppu_fallback));
+
+	while (true)
+	{
+		const u32 ref = ppu_ref(ppu.cia);
+
+		if (ref != fallback)
+		{
+			if (!ppu_async_is_stub(ref))
+			{
+				return false;
+			}
+
+			// Count function entry
+			if (const auto async = fxm::get<ppu_async_compiler>())
+			{
+				reader_lock lock(async->mutex);
+
+				const auto found = async->parts.upper_bound(ppu.cia);
+
+				if (found != async->parts.begin() && ppu.cia < std::prev(found)->second->end)
+				{
+					std::prev(found)->second->hits++;
+				}
+			}
+		}
+
+		// Interpret until branch
+		while (true)
+		{
+			const u32 op = vm::read32(ppu.cia);
+
+			if (!table[ppu_decode(op)](ppu, {op}))
+			{
+				break;
+			}
+
+			ppu.cia += 4;
+		}
+
+		if (ppu.test_stopped())
+		{
+			return false;
+		}
+	}
+}
+
+// Create interpreter entry stubs for all function blocks (sets cia and jumps to the interpreter)
+static std::shared_ptr<const std::unordered_map<std::string, u64>> ppu_async_stubs(const ppu_module& info, u32 reloc)
+{
+	if (s_ppu_stub_count >= s_ppu_stub_ranges.size())
+	{
+		return nullptr;
+	}
+
+	const u32 cia_offset = ::offset32(&ppu_thread::cia);
+	const u64 target = reinterpret_cast<u64>(&ppu_async_interpreter);
+
+	std::unordered_map<std::string, std::string> code;
+	std::unordered_map<std::string, u32> addrs;
+
+	for (const auto& func : info.funcs)
+	{
+		if (!func.size) continue;
+
+		for (const auto& block : func.blocks)
+		{
+			if (!block.second) continue;
+
+			std::string stub(24, '\0');
+			stub[0x0] = '\xc7'; // MOV dword [arg0 + cia], imm32
+#ifdef _WIN32
+			stub[0x1] = '\x81';
+#else
+			stub[0x1] = '\x87';
+#endif
+			std::memcpy(&stub[0x2], &cia_offset, 4);
+			std::memcpy(&stub[0x6], &block.first, 4);
+			stub[0xa] = '\xff'; // JMP [rip+0]
+			stub[0xb] = '\x25';
+			std::memcpy(&stub[0x10], &target, 8);
+
+			const std::string name = fmt::format("__0x%x", block.first - reloc);
+			addrs.emplace(name, block.first);
+			code.emplace(name, std::move(stub));
+		}
+	}
+
+	if (code.empty())
+	{
+		return nullptr;
+	}
+
+	auto result = std::make_shared<std::unordered_map<std::string, u64>>(jit_compiler::add(std::move(code)));
+
+	u64 min = -1;
+	u64 max = 0;
+
+	for (const auto& pair : *result)
+	{
+		min = std::min(min, pair.second);
+		max = std::max(max, pair.second);
+		ppu_ref(addrs.at(pair.first)) = ::narrow<u32>(pair.second);
+	}
+
+	s_ppu_stub_ranges[s_ppu_stub_count] = {min, max + 24};
+	s_ppu_stub_count++;
+
+	return result;
+}
+
+// Link compiled part and replace its stubs
+static void ppu_async_link(ppu_async_compiler& async, ppu_async_part& part)
+{
+	const std::string path = part.cache_path + part.obj_name;
+
+	if (Emu.IsStopped() || !fs::is_file(path))
+	{
+		return;
+	}
+
+	const auto stubs = part.stubs;
+
+	// Functions of other parts are called through the stubs
+	jit_compiler jit(async.link_table, g_cfg.core.llvm_cpu, false, [stubs](const std::string& name) -> u64
+	{
+		const auto found = stubs->find(name);
+		return found == stubs->end() ? 0 : found->second;
+	});
+
+	jit.add(path);
+	jit.fin();
+
+	for (const auto& var : part.globals)
+	{
+		if (const u64 addr = jit.get(var.first))
+		{
+			*reinterpret_cast<u64*>(addr) = var.second;
+		}
+	}
+
+	for (const auto& func : part.part.funcs)
+	{
+		if (func.size)
+		{
+			if (const u64 addr = jit.get(func.name))
+			{
+				atomic_storage<u32>::store(ppu_ref(func.addr), ::narrow<u32>(addr));
+			}
+		}
+	}
+
+	std::lock_guard lock(async.mutex);
+	async.parts.erase(part.start);
+
+	LOG_SUCCESS(PPU, "LLVM: Linked module %s", part.obj_name);
+}
+
+// Compile queued parts, most frequently executed first
+static void ppu_async_worker(ppu_async_compiler& async, const std::shared_ptr<jit_core_allocator>& jcores)
+{
+	// Set low priority
+	thread_ctrl::set_native_priority(-1);
+
+	while (!Emu.IsStopped())
+	{
+		std::shared_ptr<ppu_async_part> part;
+		{
+			std::lock_guard lock(async.mutex);
+
+			const auto found = std::max_element(async.queue.begin(), async.queue.end(), [](const auto& a, const auto& b)
+			{
+				return a->hits < b->hits;
+			});
+
+			if (found == async.queue.end())
+			{
+				return;
+			}
+
+			part = std::move(*found);
+			async.queue.erase(found);
+		}
+
+		{
+			std::lock_guard jlock(jcores->sem);
+
+			if (Emu.IsStopped())
+			{
+				return;
+			}
+
+			// Use another JIT instance
+			jit_compiler jit2({}, g_cfg.core.llvm_cpu);
+			ppu_initialize2(jit2, part->part, part->cache_path, part->obj_name);
+		}
+
+		ppu_async_link(async, *part);
+	}
+}
+#endif
+
 extern void ppu_initialize(const ppu_module& info)
 {
 	if (g_cfg.core.ppu_decoder != ppu_decoder_type::llvm)
@@ -1366,16 +1980,6 @@ extern void ppu_initialize(const ppu_module& info)
 		std::vector<ppu_function_t> funcs;
 	};
 
-	struct jit_core_allocator
-	{
-		::semaphore<0x7fffffff> sem;
-
-		jit_core_allocator(s32 arg)
-			: sem(arg)
-		{
-		}
-	};
-
 	// Permanently loaded compiled PPU modules (name -> data)
 	jit_module& jit_mod = fxm::get_always<std::unordered_map<std::string, jit_module>>()->emplace(cache_path + info.name, jit_module{}).first->second;
 
@@ -1402,12 +2006,41 @@ extern void ppu_initialize(const ppu_module& info)
 	// Difference between function name and current location
 	const u32 reloc = info.name.empty() ? 0 : info.segs.at(0).addr;
 
+	// Background compilation: execute the interpreter until compiled parts are linked
+	std::shared_ptr<ppu_async_compiler> async;
+	std::shared_ptr<const std::unordered_map<std::string, u64>> stubs;
+
+	if (g_cfg.core.ppu_async_compile && jit_mod.vars.empty() && get_current_cpu_thread())
+	{
+		async = fxm::get_always<ppu_async_compiler>(s_link_table);
+
+		std::lock_guard lock(async->mutex);
+
+		stubs = ppu_async_stubs(info, reloc);
+
+		if (!stubs)
+		{
+			async.reset();
+		}
+	}
+
 	while (jit_mod.vars.empty() && fpos < info.funcs.size())
 	{
 		// Initialize compiler instance
 		if (!jit && get_current_cpu_thread())
 		{
-			jit = std::make_shared<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu);
+			if (async)
+			{
+				jit = std::make_shared<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu, false, [stubs](const std::string& name) -> u64
+				{
+					const auto found = stubs->find(name);
+					return found == stubs->end() ? 0 : found->second;
+				});
+			}
+			else
+			{
+				jit = std::make_shared<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu);
+			}
 		}
 
 		// First function in current module part
@@ -1539,6 +2172,8 @@ extern void ppu_initialize(const ppu_module& info)
 			break;
 		}
 
+		const std::size_t globals_pos = globals.size();
+
 		globals.emplace_back(fmt::format("__mptr%x", suffix), (u64)vm::g_base_addr);
 		globals.emplace_back(fmt::format("__cptr%x", suffix), (u64)vm::g_exec_addr);
 
@@ -1564,6 +2199,24 @@ extern void ppu_initialize(const ppu_module& info)
 			continue;
 		}
 
+		if (async)
+		{
+			// Compile in background
+			auto apart = std::make_shared<ppu_async_part>();
+			apart->start = part.funcs.front().addr;
+			apart->end = part.funcs.back().addr + part.funcs.back().size;
+			apart->part = std::move(part);
+			apart->obj_name = obj_name;
+			apart->cache_path = cache_path;
+			apart->globals.assign(globals.begin() + globals_pos, globals.end());
+			apart->stubs = stubs;
+
+			std::lock_guard lock(async->mutex);
+			async->parts.emplace(apart->start, apart);
+			async->queue.emplace_back(std::move(apart));
+			continue;
+		}
+
 		// Update progress dialog
 		g_progr_ptotal++;
 
@@ -1604,6 +2257,24 @@ extern void ppu_initialize(const ppu_module& info)
 		thread.join();
 	}
 
+	if (async && !Emu.IsStopped())
+	{
+		std::lock_guard lock(async->mutex);
+
+		if (!async->queue.empty())
+		{
+			LOG_NOTICE(PPU, "LLVM: %u module parts will be compiled in background", async->queue.size());
+		}
+
+		for (u32 i = 0; i < std::min<u32>(jcores->thread_count, ::size32(async->queue)); i++)
+		{
+			async->workers.emplace_back(std::make_unique<named_thread<std::function<void()>>>(fmt::format("PPU LLVM Worker %u", async->workers.size()), [async = async.get(), jcores]()
+			{
+				ppu_async_worker(*async, jcores);
+			}));
+		}
+	}
+
 	if (Emu.IsStopped() || !get_current_cpu_thread())
 	{
 		return;
@@ -1625,6 +2296,18 @@ extern void ppu_initialize(const ppu_module& info)
 				if (block.second)
 				{
 					const u64 addr = jit->get(fmt::format("__0x%x", block.first - reloc));
+
+					if (async)
+					{
+						// Keep the stub if not compiled yet
+						if (addr)
+						{
+							atomic_storage<u32>::store(ppu_ref(block.first), ::narrow<u32>(addr));
+						}
+
+						continue;
+					}
+
 					jit_mod.funcs.emplace_back(reinterpret_cast<ppu_function_t>(addr));
 					ppu_ref(block.first) = ::narrow<u32>(addr);
 				}
@@ -1636,6 +2319,17 @@ extern void ppu_initialize(const ppu_module& info)
 		{
 			const u64 addr = jit->get(var.first);
 
+			if (async)
+			{
+				// Not persistent, parts compiled in background are linked separately
+				if (addr)
+				{
+					*reinterpret_cast<u64*>(addr) = var.second;
+				}
+
+				continue;
+			}
+
 			jit_mod.vars.emplace_back(reinterpret_cast<u64*>(addr));
 
 			if (addr)
@@ -169,6 +169,7 @@ public:
 
 	be_t<u64>* get_stack_arg(s32 i, u64 align = alignof(u64));
 	void exec_task();
+	void exec_blocks(); // Predecoded block interpreter (fast)
 	void fast_call(u32 addr, u32 rtoc);
 
 	static u32 stack_push(u32 size, u32 align_v);
@@ -48,9 +48,13 @@ spu_runtime::spu_runtime()
 	{
 		v.raw() = &spu_recompiler_base::dispatch;
 	}
+}
 
-	// Initialize "empty" block
-	m_map[std::vector<u32>()] = &spu_recompiler_base::dispatch;
+spu_runtime::~spu_runtime()
+{
+	std::string stats;
+	m_map.dump(stats);
+	LOG_NOTICE(SPU, "SPU Recompiler Runtime (ASMJIT): %s", stats);
 }
 
 spu_recompiler::spu_recompiler()
@@ -79,29 +83,59 @@ spu_function_t spu_recompiler::get(u32 lsa)
 	return m_spurt->m_dispatcher[lsa / 4];
 }
 
-spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
+spu_function_t spu_recompiler::find(const std::vector<u32>& func)
 {
 	init();
 
-	// Don't lock without shared runtime
-	std::unique_lock lock(m_spurt->m_mutex, std::defer_lock);
+	if (const auto found = m_spurt->m_map.find(func))
+	{
+		return found->func;
+	}
 
-	if (g_cfg.core.spu_shared_runtime)
+	return nullptr;
+}
+
+spu_function_t spu_recompiler::find(const be_t<u32>* ls, u32 addr)
+{
+	init();
+
+	if (const auto found = m_spurt->m_map.match(ls, addr))
 	{
-		lock.lock();
+		return found->func;
 	}
 
+	return nullptr;
+}
+
+spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
+{
+	init();
+
 	// Try to find existing function, register new one if necessary
-	const auto fn_info = m_spurt->m_map.emplace(std::move(func_rv), nullptr);
+	const auto fn_info = m_spurt->m_map.emplace(std::move(func_rv));
 
-	auto& fn_location = fn_info.first->second;
+	auto& fn_location = fn_info.first->func;
 
-	if (fn_location)
+	if (!fn_info.second)
 	{
-		return fn_location;
+		// Wait if the function is being compiled by another thread
+		while (g_cfg.core.spu_shared_runtime && !fn_location && !fn_info.first->failed)
+		{
+			std::this_thread::yield();
+		}
+
+		if (const auto fn = fn_location.load())
+		{
+			return fn;
+		}
+
+		if (fn_info.first->failed)
+		{
+			return nullptr;
+		}
 	}
 
-	auto& func = fn_info.first->first;
+	auto& func = fn_info.first->data;
 
 	using namespace asmjit;
 
@@ -190,6 +224,23 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 		}
 	}
 
+	// Tiered mode: count function entries, promote to LLVM when hot
+#ifdef LLVM_AVAILABLE
+	const bool tiered = g_cfg.core.spu_tiered && g_cfg.core.spu_shared_runtime;
+#else
+	const bool tiered = false;
+#endif
+
+	if (tiered)
+	{
+		// Far jump slot for the promoted function (jmp qword ptr [rip + 2], 2x int3, address)
+		c->dq(0xcccc0000000225ff);
+		c->dq(0);
+
+		// Patch point for the promoted function (8-byte NOP), entry point
+		c->dq(0x841f0f);
+	}
+
 	// Set PC and check status
 	c->mov(SPU_OFF_32(pc), m_pos);
 	c->cmp(SPU_OFF_32(state), 0);
@@ -712,6 +763,25 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 	// Acknowledge success and add statistics
 	c->add(SPU_OFF_64(block_counter), ::size32(words) / (words_align / 4));
 
+	if (tiered)
+	{
+		// Request promotion exactly once, when the counter reaches the threshold (shared by all SPU threads)
+		Label label_hot = c->newLabel();
+		c->mov(x86::rax, imm_ptr(&fn_info.first->hits));
+		c->mov(qw0->r32(), 1);
+		c->lock().xadd(x86::qword_ptr(x86::rax), *qw0);
+		c->cmp(*qw0, static_cast<s32>(g_cfg.core.spu_tiered_threshold.get() - 1));
+		c->je(label_hot);
+
+		after.emplace_back([=]
+		{
+			c->align(kAlignCode, 16);
+			c->bind(label_hot);
+			c->mov(*qw0, imm_ptr(fn_info.first));
+			c->jmp(imm_ptr(&spu_recompiler_base::promote));
+		});
+	}
+
 	if (g_cfg.core.spu_block_size == spu_block_size_type::giga && m_pos != start)
 	{
 		// Jump to the entry point if necessary
@@ -858,12 +928,30 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 	instr_labels.clear();
 	xmm_consts.clear();
 
+	// Don't lock without shared runtime
+	std::unique_lock lock(m_spurt->m_mutex, std::defer_lock);
+
+	if (g_cfg.core.spu_shared_runtime)
+	{
+		lock.lock();
+	}
+
 	// Compile and get function address
 	spu_function_t fn;
 
 	if (m_spurt->m_jitrt.add(&fn, &code))
 	{
-		LOG_FATAL(SPU, "Failed to build a function");
+		LOG_FATAL(SPU, "[0x%05x] Failed to build a function", func[0]);
+
+		// Release the waiting threads, the block is left to the interpreter
+		fn_info.first->failed = true;
+		return nullptr;
+	}
+
+	if (tiered && fn)
+	{
+		// Skip the far jump slot
+		fn = reinterpret_cast<spu_function_t>(reinterpret_cast<u8*>(fn) + 16);
 	}
 
 	// Register function
@@ -886,11 +974,10 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 	}
 
 	// Generate a dispatcher (übertrampoline)
-	std::vector<u32> addrv{func[0]};
-	const auto beg = m_spurt->m_map.lower_bound(addrv);
-	addrv[0] += 4;
-	const auto _end = m_spurt->m_map.lower_bound(addrv);
-	const u32 size0 = std::distance(beg, _end);
+	const auto all = m_spurt->m_map.get_all(func[0]);
+	const auto beg = all.cbegin();
+	const auto _end = all.cend();
+	const u32 size0 = ::size32(all);
 
 	if (size0 == 1)
 	{
@@ -917,8 +1004,8 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 			u32 size;
 			u32 level;
 			Label label;
-			std::map<std::vector<u32>, spu_function_t>::iterator beg;
-			std::map<std::vector<u32>, spu_function_t>::iterator end;
+			std::vector<spu_function_map::entry*>::const_iterator beg;
+			std::vector<spu_function_map::entry*>::const_iterator end;
 		};
 
 		std::vector<work> workload;
@@ -946,13 +1033,13 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 				it = it2;
 				size1 = w.size - size2;
 
-				if (w.level >= w.beg->first.size())
+				if (w.level >= (*w.beg)->data.size())
 				{
 					// Cannot split: smallest function is a prefix of bigger ones (TODO)
 					break;
 				}
 
-				const u32 x1 = w.beg->first.at(w.level);
+				const u32 x1 = (*w.beg)->data.at(w.level);
 
 				if (!x1)
 				{
@@ -962,7 +1049,7 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 				}
 
 				// Adjust ranges (forward)
-				while (it != w.end && x1 == it->first.at(w.level))
+				while (it != w.end && x1 == (*it)->data.at(w.level))
 				{
 					it++;
 					size1++;
@@ -986,23 +1073,23 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 				c->bind(w.label);
 			}
 
-			if (w.level >= w.beg->first.size())
+			if (w.level >= (*w.beg)->data.size())
 			{
 				// If functions cannot be compared, assume smallest function
 				LOG_ERROR(SPU, "Trampoline simplified at 0x%x (level=%u)", func[0], w.level);
-				c->jmp(imm_ptr(w.beg->second ? w.beg->second : &dispatch));
+				c->jmp(imm_ptr((*w.beg)->func.load() ? (*w.beg)->func.load() : &dispatch));
 				continue;
 			}
 
 			// Value for comparison
-			const u32 x = it->first.at(w.level);
+			const u32 x = (*it)->data.at(w.level);
 
 			// Adjust ranges (backward)
 			while (true)
 			{
 				it--;
 
-				if (it->first.at(w.level) != x)
+				if ((*it)->data.at(w.level) != x)
 				{
 					it++;
 					break;
@@ -1033,7 +1120,7 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 			}
 
 			// Second subrange target
-			const auto target = it->second ? it->second : &dispatch;
+			const auto target = (*it)->func.load() ? (*it)->func.load() : &dispatch;
 
 			if (size2 == 1)
 			{
@@ -1044,7 +1131,7 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 				it2 = it;
 
 				// Select additional midrange for equality comparison
-				while (it2 != w.end && it2->first.at(w.level) == x)
+				while (it2 != w.end && (*it2)->data.at(w.level) == x)
 				{
 					size2--;
 					it2++;
@@ -1088,7 +1175,7 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 					if (label_above.isValid())
 					{
 						c->bind(label_above);
-						c->jmp(imm_ptr(it2->second ? it2->second : &dispatch));
+						c->jmp(imm_ptr((*it2)->func.load() ? (*it2)->func.load() : &dispatch));
 					}
 				}
 				else
@@ -1104,7 +1191,7 @@ spu_function_t spu_recompiler::compile(std::vector<u32>&& func_rv)
 			if (label_below.isValid())
 			{
 				c->bind(label_below);
-				c->jmp(imm_ptr(w.beg->second ? w.beg->second : &dispatch));
+				c->jmp(imm_ptr((*w.beg)->func.load() ? (*w.beg)->func.load() : &dispatch));
 			}
 		}
 
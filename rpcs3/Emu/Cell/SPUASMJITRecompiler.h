@@ -14,7 +14,7 @@ class spu_runtime
 	asmjit::JitRuntime m_jitrt;
 
 	// All functions
-	std::map<std::vector<u32>, spu_function_t> m_map;
+	spu_function_map m_map;
 
 	// All dispatchers
 	std::array<atomic_t<spu_function_t>, 0x10000> m_dispatcher;
@@ -26,6 +26,8 @@ class spu_runtime
 
 public:
 	spu_runtime();
+
+	~spu_runtime();
 };
 
 // SPU ASMJIT Recompiler
@@ -42,6 +44,10 @@ public:
 
 	virtual spu_function_t compile(std::vector<u32>&&) override;
 
+	virtual spu_function_t find(const std::vector<u32>&) override;
+
+	virtual spu_function_t find(const be_t<u32>* ls, u32 addr) override;
+
 private:
 	// emitter:
 	asmjit::X86Assembler* c;
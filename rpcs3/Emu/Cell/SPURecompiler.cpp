@@ -4,6 +4,8 @@
 #include "Emu/Memory/vm.h"
 #include "Crypto/sha1.h"
 #include "Utilities/StrUtil.h"
+#include "Utilities/JIT.h"
+#include "Utilities/cond.h"
 
 #include "SPUThread.h"
 #include "SPUAnalyser.h"
@@ -12,6 +14,7 @@
 #include "SPURecompiler.h"
 #include "PPUAnalyser.h"
 #include <algorithm>
+#include <deque>
 #include <mutex>
 #include <thread>
 
@@ -19,39 +22,268 @@ extern atomic_t<const char*> g_progr;
 extern atomic_t<u64> g_progr_ptotal;
 extern atomic_t<u64> g_progr_pdone;
 
+extern const spu_decoder<spu_interpreter_fast> g_spu_interpreter_fast;
+
 const spu_decoder<spu_itype> s_spu_itype;
 const spu_decoder<spu_iname> s_spu_iname;
 
 extern u64 get_timebased_time();
 
+// SPU cache file header
+struct spu_cache_header
+{
+	le_t<u32> magic;
+	le_t<u32> version;
+	le_t<u64> reserved;
+};
+
+// SPU cache record header (followed by raw instruction data)
+struct spu_cache_record
+{
+	le_t<u32> magic;
+	le_t<u32> addr;
+	le_t<u32> size;
+	le_t<u32> reserved;
+	le_t<u64> hash;
+};
+
+constexpr u32 s_spu_cache_magic = 0x43555053; // "SPUC"
+constexpr u32 s_spu_cache_version = 6;
+constexpr u32 s_spu_record_magic = 0x46555053; // "SPUF"
+
+u64 spu_cache::hash(u32 addr, const u32* data, u32 size)
+{
+	sha1_context ctx;
+	u8 output[20];
+
+	const le_t<u32> _addr = addr;
+
+	sha1_starts(&ctx);
+	sha1_update(&ctx, reinterpret_cast<const u8*>(&_addr), sizeof(_addr));
+	sha1_update(&ctx, reinterpret_cast<const u8*>(data), size * 4);
+	sha1_finish(&ctx, output);
+
+	u64 result;
+	std::memcpy(&result, output, sizeof(result));
+	return result;
+}
+
+std::vector<u32> spu_cache::func_view::get() const
+{
+	std::vector<u32> result(size + 1);
+	result[0] = addr;
+	std::memcpy(result.data() + 1, data, size * 4);
+	return result;
+}
+
 spu_cache::spu_cache(const std::string& loc)
 	: m_file(loc, fs::read + fs::write + fs::create)
 {
+	if (!m_file)
+	{
+		return;
+	}
+
+	spu_cache_header header{};
+
+	if (m_file.size() < sizeof(header) || !m_file.read(header) || header.magic != s_spu_cache_magic || header.version != s_spu_cache_version)
+	{
+		if (m_file.size())
+		{
+			LOG_ERROR(SPU, "SPU Cache: invalid or outdated file cleared: %s", loc);
+		}
+
+		header.magic = s_spu_cache_magic;
+		header.version = s_spu_cache_version;
+		header.reserved = 0;
+
+		m_file.trunc(0);
+		m_file.seek(0);
+		m_file.write(header);
+	}
+
+	const u64 file_size = m_file.size();
+
+	// Validate records and build the index
+	m_end = fs::map_records(m_file, m_view, sizeof(header), [&](u64 pos, const uchar* data, u64 avail) -> u64
+	{
+		spu_cache_record rec;
+
+		if (avail < sizeof(rec))
+		{
+			return 0;
+		}
+
+		std::memcpy(&rec, data, sizeof(rec));
+
+		const u64 size = sizeof(rec) + u64{rec.size} * 4;
+
+		if (rec.magic != s_spu_record_magic || rec.size == 0 || rec.size > 0x10000 || rec.addr >= 0x40000 || rec.addr % 4 || size > avail)
+		{
+			return 0;
+		}
+
+		const auto func = reinterpret_cast<const u32*>(data + sizeof(rec));
+
+		// Detect torn writes and corrupted data
+		if (hash(rec.addr, func, rec.size) != rec.hash)
+		{
+			return 0;
+		}
+
+		// Skip duplicates (hash collisions are indexed separately)
+		if (!find(rec.hash, rec.addr, func, rec.size))
+		{
+			m_index.emplace(rec.hash, pos);
+		}
+
+		return size;
+	});
+
+	if (!m_view)
+	{
+		LOG_ERROR(SPU, "SPU Cache: failed to map %s (%s), cache disabled", loc, fs::g_tls_error);
+		m_file.close();
+		m_index.clear();
+		return;
+	}
+
+	if (m_end < file_size)
+	{
+		LOG_ERROR(SPU, "SPU Cache: damaged record at 0x%x (file size 0x%x), the rest is discarded", m_end, file_size);
+	}
 }
 
 spu_cache::~spu_cache()
 {
 }
 
-std::deque<std::vector<u32>> spu_cache::get()
+std::vector<spu_cache::func_view> spu_cache::get()
 {
-	std::deque<std::vector<u32>> result;
+	std::vector<func_view> result;
 
-	if (!m_file)
+	reader_lock lock(m_mutex);
+
+	if (!m_view)
 	{
 		return result;
 	}
 
-	m_file.seek(0);
+	result.reserve(m_index.size());
+
+	for (u64 pos = sizeof(spu_cache_header); pos < m_view.size();)
+	{
+		spu_cache_record rec;
+		std::memcpy(&rec, m_view.data() + pos, sizeof(rec));
+
+		// Skip duplicates (only indexed records are returned)
+		const auto range = m_index.equal_range(rec.hash);
+
+		if (std::any_of(range.first, range.second, [&](const auto& entry) { return entry.second == pos; }))
+		{
+			result.push_back({rec.addr, rec.size, reinterpret_cast<const u32*>(m_view.data() + pos + sizeof(rec))});
+		}
+
+		pos += sizeof(rec) + u64{rec.size} * 4;
+	}
+
+	std::reverse(result.begin(), result.end());
+	return result;
+}
+
+bool spu_cache::find(u64 key, u32 addr, const u32* data, u32 size)
+{
+	const auto range = m_index.equal_range(key);
+
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		spu_cache_record rec;
+
+		if (it->second + sizeof(rec) <= m_view.size())
+		{
+			std::memcpy(&rec, m_view.data() + it->second, sizeof(rec));
+
+			if (rec.addr == addr && rec.size == size && std::memcmp(m_view.data() + it->second + sizeof(rec), data, size * 4) == 0)
+			{
+				return true;
+			}
+
+			continue;
+		}
+
+		// Record was added after opening the file
+		std::vector<u32> stored;
+
+		if (m_file.seek(it->second), m_file.read(rec) && rec.addr == addr && rec.size == size && m_file.read(stored, size) && std::memcmp(stored.data(), data, size * 4) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void spu_cache::add(const std::vector<u32>& func)
+{
+	if (!m_file)
+	{
+		return;
+	}
+
+	const u32 size = ::size32(func) - 1;
+	const u64 key = hash(func[0], func.data() + 1, size);
+
+	std::lock_guard lock(m_mutex);
+
+	if (find(key, func[0], func.data() + 1, size))
+	{
+		return;
+	}
+
+	spu_cache_record rec;
+	rec.magic = s_spu_record_magic;
+	rec.addr = func[0];
+	rec.size = size;
+	rec.reserved = 0;
+	rec.hash = key;
+
+	// Write the whole record at once
+	std::vector<u8> buf(sizeof(rec) + size * 4);
+	std::memcpy(buf.data(), &rec, sizeof(rec));
+	std::memcpy(buf.data() + sizeof(rec), func.data() + 1, size * 4);
+
+	m_file.seek(m_end);
+
+	if (m_file.write(buf.data(), buf.size()) != buf.size())
+	{
+		LOG_ERROR(SPU, "SPU Cache: failed to write function 0x%05x (%s)", func[0], fs::g_tls_error);
+		m_file.trunc(m_end);
+		return;
+	}
+
+	m_index.emplace(key, m_end);
+	m_end += buf.size();
+}
+
+// Import functions from the old SPU cache format (v5)
+static void spu_cache_import_v5(spu_cache& cache, const std::string& path)
+{
+	const fs::file old(path);
+
+	if (!old)
+	{
+		return;
+	}
+
+	u32 count = 0;
 
-	// TODO: signal truncated or otherwise broken file
 	while (true)
 	{
 		be_t<u32> size;
 		be_t<u32> addr;
 		std::vector<u32> func;
 
-		if (!m_file.read(size) || !m_file.read(addr))
+		if (!old.read(size) || !old.read(addr) || size == 0 || size > 0x10000)
 		{
 			break;
 		}
@@ -59,29 +291,66 @@ std::deque<std::vector<u32>> spu_cache::get()
 		func.resize(size + 1);
 		func[0] = addr;
 
-		if (m_file.read(func.data() + 1, func.size() * 4 - 4) != func.size() * 4 - 4)
+		if (old.read(func.data() + 1, func.size() * 4 - 4) != func.size() * 4 - 4)
 		{
 			break;
 		}
 
-		result.emplace_front(std::move(func));
+		cache.add(func);
+		count++;
 	}
 
-	return result;
+	LOG_SUCCESS(SPU, "SPU Cache: imported %u functions from %s", count, path);
 }
 
-void spu_cache::add(const std::vector<u32>& func)
+// Get compilation thread limit shared with PPU LLVM
+static std::shared_ptr<jit_core_allocator> spu_get_jit_cores()
 {
-	if (!m_file)
+	u32 max_threads = static_cast<u32>(g_cfg.core.llvm_threads);
+	s32 thread_count = max_threads > 0 ? std::min(max_threads, std::thread::hardware_concurrency()) : std::thread::hardware_concurrency();
+	return fxm::get_always<jit_core_allocator>(std::max<s32>(thread_count, 1));
+}
+
+// Analyse and compile the function using fake LS (must be zero-filled) initialized with its data only
+static spu_function_t spu_build_function(spu_recompiler_base& compiler, std::vector<be_t<u32>>& ls, std::vector<u32>&& func)
+{
+	// Get data start
+	const u32 start = func[0] * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
+	const u32 size0 = ::size32(func);
+
+	// Initialize LS with function data only
+	for (u32 i = 1, pos = start; i < size0; i++, pos += 4)
 	{
-		return;
+		ls[pos / 4] = se_storage<u32>::swap(func[i]);
+	}
+
+	// Call analyser
+	std::vector<u32> func2 = compiler.block(ls.data(), func[0]);
+
+	if (func2.size() != size0)
+	{
+		LOG_ERROR(SPU, "[0x%05x] SPU Analyser failed, %u vs %u", func2[0], func2.size() - 1, size0 - 1);
 	}
 
-	be_t<u32> size = ::size32(func) - 1;
-	be_t<u32> addr = func[0];
-	m_file.write(size);
-	m_file.write(addr);
-	m_file.write(func.data() + 1, func.size() * 4 - 4);
+	const auto result = compiler.compile(std::move(func));
+
+	// Clear fake LS
+	for (u32 i = 1, pos = start; i < func2.size(); i++, pos += 4)
+	{
+		if (se_storage<u32>::swap(func2[i]) != ls[pos / 4])
+		{
+			LOG_ERROR(SPU, "[0x%05x] SPU Analyser failed at 0x%x", func2[0], pos);
+		}
+
+		ls[pos / 4] = 0;
+	}
+
+	if (func2.size() != size0)
+	{
+		std::memset(ls.data(), 0, 0x40000);
+	}
+
+	return result;
 }
 
 void spu_cache::initialize()
@@ -94,7 +363,10 @@ void spu_cache::initialize()
 	}
 
 	// SPU cache file (version + block size type)
-	const std::string loc = _main->cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-v5.dat";
+	const std::string loc = _main->cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-v6.dat";
+	const std::string old_loc = _main->cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-v5.dat";
+
+	const bool is_new = !fs::is_file(loc);
 
 	auto cache = std::make_shared<spu_cache>(loc);
 
@@ -104,103 +376,604 @@ void spu_cache::initialize()
 		return;
 	}
 
+	if (is_new && fs::is_file(old_loc))
+	{
+		spu_cache_import_v5(*cache, old_loc);
+
+		// Reopen to map imported functions
+		cache.reset();
+		cache = std::make_shared<spu_cache>(loc);
+	}
+
 	// Read cache
 	auto func_list = cache->get();
 
+	// Recompiler instance factory for cache initialization
+	const auto make_compiler = []() -> std::unique_ptr<spu_recompiler_base>
+	{
+		std::unique_ptr<spu_recompiler_base> compiler;
+
+		if (g_cfg.core.spu_decoder == spu_decoder_type::asmjit)
+		{
+			compiler = spu_recompiler_base::make_asmjit_recompiler();
+		}
+
+		if (g_cfg.core.spu_decoder == spu_decoder_type::llvm)
+		{
+			compiler = spu_recompiler_base::make_llvm_recompiler();
+		}
+
+		if (compiler)
+		{
+			compiler->init();
+		}
+
+		return compiler;
+	};
+
 	// Recompiler instance for cache initialization
-	std::unique_ptr<spu_recompiler_base> compiler;
+	std::unique_ptr<spu_recompiler_base> compiler = make_compiler();
 
-	if (g_cfg.core.spu_decoder == spu_decoder_type::asmjit)
+	if (compiler && !func_list.empty())
 	{
-		compiler = spu_recompiler_base::make_asmjit_recompiler();
+		// Initialize progress dialog (wait for previous progress done)
+		while (g_progr_ptotal)
+		{
+			std::this_thread::sleep_for(5ms);
+		}
+
+		g_progr = "Building SPU cache...";
+		g_progr_ptotal += func_list.size();
+
+		// Share the limit of compilation threads with PPU LLVM
+		const auto jcores = spu_get_jit_cores();
+		const u32 worker_count = std::min<u32>(std::max<s32>(jcores->thread_count, 1), ::size32(func_list));
+
+		// Index of the next function to build
+		atomic_t<u32> fnext{0};
+
+		// Build functions (each worker has its own recompiler and fake LS)
+		const auto build = [&](spu_recompiler_base& compiler)
+		{
+			// Fake LS
+			std::vector<be_t<u32>> ls(0x10000);
+
+			for (u32 index = fnext++; index < func_list.size(); index = fnext++)
+			{
+				std::vector<u32> func = func_list[index].get();
+
+				if (Emu.IsStopped())
+				{
+					g_progr_pdone++;
+					continue;
+				}
+
+				// Allocate "core"
+				std::lock_guard jlock(jcores->sem);
+
+				spu_build_function(compiler, ls, std::move(func));
+
+				g_progr_pdone++;
+			}
+		};
+
+		// Worker threads
+		std::vector<std::thread> workers;
+
+		for (u32 i = 1; i < worker_count; i++)
+		{
+			workers.emplace_back([&]()
+			{
+				// Set low priority
+				thread_ctrl::set_native_priority(-1);
+
+				if (const auto compiler2 = make_compiler())
+				{
+					build(*compiler2);
+				}
+			});
+		}
+
+		// Current thread also participates
+		build(*compiler);
+
+		// Join worker threads
+		for (auto& thread : workers)
+		{
+			thread.join();
+		}
+
+		if (Emu.IsStopped())
+		{
+			LOG_ERROR(SPU, "SPU Runtime: Cache building aborted.");
+			return;
+		}
+
+		LOG_SUCCESS(SPU, "SPU Runtime: Built %u functions (%u threads).", func_list.size(), worker_count);
 	}
 
-	if (g_cfg.core.spu_decoder == spu_decoder_type::llvm)
+	// Register cache instance
+	fxm::import<spu_cache>([&]() -> std::shared_ptr<spu_cache>&&
 	{
-		compiler = spu_recompiler_base::make_llvm_recompiler();
+		return std::move(cache);
+	});
+}
+
+// Background SPU compilation queue (shared runtime only)
+class spu_compile_queue
+{
+	struct worker
+	{
+		spu_compile_queue& queue;
+
+		worker(spu_compile_queue& queue)
+			: queue(queue)
+		{
+		}
+
+		void operator()();
+	};
+
+	shared_mutex m_mutex;
+
+	cond_variable m_cond;
+
+	// Functions waiting for compilation
+	std::deque<std::vector<u32>> m_queue;
+
+	bool m_stop = false;
+
+	// Entry points of the queued functions
+	std::array<atomic_t<u8>, 0x10000> m_pending{};
+
+	std::vector<std::unique_ptr<named_thread<worker>>> m_workers;
+
+	// Statistics
+	atomic_t<u64> m_queued{0};
+	atomic_t<u64> m_compiled{0};
+	atomic_t<u64> m_interpreted{0};
+
+public:
+	spu_compile_queue();
+
+	~spu_compile_queue();
+
+	// Check whether the function at given entry point is waiting for compilation
+	bool is_pending(u32 addr) const
+	{
+		return m_pending[addr / 4 % m_pending.size()] != 0;
 	}
 
-	if (compiler)
+	// Add function to the queue (returns false if the entry point is already queued)
+	bool push(std::vector<u32>&& func);
+
+	// Execute instructions with the interpreter until the first branch
+	void interpret(spu_thread& spu);
+};
+
+spu_compile_queue::spu_compile_queue()
+{
+	// Leave half of the compilation threads to emulated threads
+	const u32 worker_count = std::max<s32>(spu_get_jit_cores()->thread_count / 2, 1);
+
+	for (u32 i = 0; i < worker_count; i++)
 	{
-		compiler->init();
+		m_workers.emplace_back(std::make_unique<named_thread<worker>>(fmt::format("SPU Compiler %u", i), *this));
 	}
 
-	if (compiler && !func_list.empty())
+	LOG_NOTICE(SPU, "SPU async compilation: %u worker threads", worker_count);
+}
+
+spu_compile_queue::~spu_compile_queue()
+{
 	{
-		// Fake LS
-		std::vector<be_t<u32>> ls(0x10000);
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
 
-		// Initialize progress dialog (wait for previous progress done)
-		while (g_progr_ptotal)
+	m_cond.notify_all();
+	m_workers.clear();
+
+	LOG_NOTICE(SPU, "SPU async compilation: queued %u, compiled %u, interpreted blocks: %u", m_queued.load(), m_compiled.load(), m_interpreted.load());
+}
+
+bool spu_compile_queue::push(std::vector<u32>&& func)
+{
+	if (m_pending[func[0] / 4 % m_pending.size()].exchange(1))
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+		m_queue.emplace_back(std::move(func));
+	}
+
+	m_queued++;
+	m_cond.notify_one();
+	return true;
+}
+
+// Execute instructions with the interpreter until the first branch
+static void spu_interpret_block(spu_thread& spu)
+{
+	const auto ls = spu._ptr<u32>(0);
+
+	while (true)
+	{
+		const u32 op = ls[spu.pc / 4];
+
+		if (!g_spu_interpreter_fast.decode(op)(spu, {op}))
 		{
-			std::this_thread::sleep_for(5ms);
+			break;
 		}
 
-		g_progr = "Building SPU cache...";
-		g_progr_ptotal += func_list.size();
+		spu.pc += 4;
+
+		if (UNLIKELY(spu.state))
+		{
+			break;
+		}
+	}
+}
+
+void spu_compile_queue::interpret(spu_thread& spu)
+{
+	spu_interpret_block(spu);
+	m_interpreted++;
+}
+
+void spu_compile_queue::worker::operator()()
+{
+	// Set low priority
+	thread_ctrl::set_native_priority(-1);
+
+	// Own recompiler instance and fake LS
+	std::unique_ptr<spu_recompiler_base> compiler = g_cfg.core.spu_decoder == spu_decoder_type::llvm
+		? spu_recompiler_base::make_llvm_recompiler()
+		: spu_recompiler_base::make_asmjit_recompiler();
+
+	compiler->init();
+
+	std::vector<be_t<u32>> ls(0x10000);
+
+	const auto jcores = spu_get_jit_cores();
+
+	while (true)
+	{
+		std::vector<u32> func;
 
-		// Build functions
-		for (auto&& func : func_list)
 		{
-			if (Emu.IsStopped())
+			std::unique_lock lock(queue.m_mutex);
+
+			while (!queue.m_stop && queue.m_queue.empty())
 			{
-				g_progr_pdone++;
-				continue;
+				queue.m_cond.wait(lock);
+			}
+
+			if (queue.m_stop)
+			{
+				return;
 			}
 
-			// Get data start
-			const u32 start = func[0] * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
-			const u32 size0 = ::size32(func);
+			func = std::move(queue.m_queue.front());
+			queue.m_queue.pop_front();
+		}
+
+		const u32 addr = func[0];
+
+		if (!Emu.IsStopped())
+		{
+			// Allocate "core"
+			std::lock_guard jlock(jcores->sem);
+
+			spu_build_function(*compiler, ls, std::move(func));
+			queue.m_compiled++;
+		}
+
+		queue.m_pending[addr / 4 % queue.m_pending.size()] = 0;
+	}
+}
+
+// Background recompilation of hot ASMJIT functions with LLVM (tiered mode)
+class spu_promote_queue
+{
+	struct worker
+	{
+		spu_promote_queue& queue;
+
+		worker(spu_promote_queue& queue)
+			: queue(queue)
+		{
+		}
+
+		void operator()();
+	};
+
+	shared_mutex m_mutex;
+
+	cond_variable m_cond;
+
+	// Hot functions (owned by the shared ASMJIT runtime)
+	std::deque<spu_function_map::entry*> m_queue;
+
+	bool m_stop = false;
+
+	// Single thread is enough: LLVM compilation is serialized by the shared runtime
+	std::unique_ptr<named_thread<worker>> m_worker;
+
+	// Statistics
+	atomic_t<u64> m_queued{0};
+	atomic_t<u64> m_promoted{0};
+
+public:
+	spu_promote_queue();
+
+	~spu_promote_queue();
+
+	void push(spu_function_map::entry* fn);
+};
+
+spu_promote_queue::spu_promote_queue()
+{
+	m_worker = std::make_unique<named_thread<worker>>("SPU Promoter", *this);
+}
+
+spu_promote_queue::~spu_promote_queue()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_cond.notify_all();
+	m_worker.reset();
+
+	LOG_NOTICE(SPU, "SPU tiered compilation: queued %u, promoted %u", m_queued.load(), m_promoted.load());
+}
+
+void spu_promote_queue::push(spu_function_map::entry* fn)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_queue.emplace_back(fn);
+	}
+
+	m_queued++;
+	m_cond.notify_one();
+}
+
+void spu_promote_queue::worker::operator()()
+{
+	// Set low priority
+	thread_ctrl::set_native_priority(-1);
+
+	const auto compiler = spu_recompiler_base::make_llvm_recompiler();
+	compiler->init();
+
+	// Keep the shared ASMJIT runtime (and the queued entries) alive
+	const auto base = spu_recompiler_base::make_asmjit_recompiler();
+	base->init();
+
+	std::vector<be_t<u32>> ls(0x10000);
+
+	const auto jcores = spu_get_jit_cores();
+
+	while (true)
+	{
+		spu_function_map::entry* fn;
+
+		{
+			std::unique_lock lock(queue.m_mutex);
+
+			while (!queue.m_stop && queue.m_queue.empty())
+			{
+				queue.m_cond.wait(lock);
+			}
 
-			// Initialize LS with function data only
-			for (u32 i = 1, pos = start; i < size0; i++, pos += 4)
+			if (queue.m_stop)
 			{
-				ls[pos / 4] = se_storage<u32>::swap(func[i]);
+				return;
 			}
 
-			// Call analyser
-			std::vector<u32> func2 = compiler->block(ls.data(), func[0]);
+			fn = queue.m_queue.front();
+			queue.m_queue.pop_front();
+		}
+
+		const auto old = fn->func.load();
+
+		if (Emu.IsStopped() || !old)
+		{
+			continue;
+		}
 
-			if (func2.size() != size0)
+		spu_function_t result;
+		{
+			// Allocate "core"
+			std::lock_guard jlock(jcores->sem);
+
+			result = spu_build_function(*compiler, ls, std::vector<u32>(fn->data));
+		}
+
+		if (result)
+		{
+			// Redirect the entry of the ASMJIT function (dispatchers, trampolines and patched branches follow it)
+			// The far jump slot precedes the entry point
+			const auto entry = reinterpret_cast<u8*>(old);
+
+			if (!spu_recompiler_base::patch(result, entry, entry - 16))
 			{
-				LOG_ERROR(SPU, "[0x%05x] SPU Analyser failed, %u vs %u", func2[0], func2.size() - 1, size0 - 1);
+				LOG_ERROR(SPU, "[0x%x] Failed to patch the promoted function: %p -> %p", fn->data[0], old, result);
+				continue;
 			}
 
-			compiler->compile(std::move(func));
+			queue.m_promoted++;
+			LOG_TRACE(SPU, "[0x%x] Promoted: %p -> %p", fn->data[0], old, result);
+		}
+	}
+}
+
+spu_function_map::~spu_function_map()
+{
+	for (auto& head : m_buckets)
+	{
+		for (entry* e = head.raw(); e;)
+		{
+			delete std::exchange(e, e->next_hash);
+		}
+	}
+}
+
+u64 spu_function_map::hash(const std::vector<u32>& func)
+{
+	// FNV-1a (64-bit) over 32-bit words
+	u64 result = 14695981039346656037ull;
+
+	for (u32 word : func)
+	{
+		result ^= word;
+		result *= 1099511628211ull;
+	}
+
+	return result;
+}
+
+spu_function_map::entry* spu_function_map::find(const std::vector<u32>& func, u64 hash, entry* head, entry* stop)
+{
+	u64 probes = 0;
+	u64 compares = 0;
+
+	entry* result = nullptr;
+
+	for (entry* e = head; e != stop; e = e->next_hash)
+	{
+		probes++;
 
-			// Clear fake LS
-			for (u32 i = 1, pos = start; i < func2.size(); i++, pos += 4)
+		if (e->hash == hash)
+		{
+			compares++;
+
+			if (e->data == func)
 			{
-				if (se_storage<u32>::swap(func2[i]) != ls[pos / 4])
-				{
-					LOG_ERROR(SPU, "[0x%05x] SPU Analyser failed at 0x%x", func2[0], pos);
-				}
+				result = e;
+				break;
+			}
+		}
+	}
+
+	m_lookups++;
+	m_probes += probes;
+	m_compares += compares;
+	return result;
+}
+
+spu_function_map::entry* spu_function_map::find(const std::vector<u32>& func)
+{
+	const u64 h = hash(func);
+	return find(func, h, m_buckets[h % m_buckets.size()], nullptr);
+}
+
+std::pair<spu_function_map::entry*, bool> spu_function_map::emplace(std::vector<u32>&& func)
+{
+	const u64 h = hash(func);
+
+	auto& bucket = m_buckets[h % m_buckets.size()];
+
+	entry* head = bucket;
+
+	if (entry* found = find(func, h, head, nullptr))
+	{
+		return {found, false};
+	}
+
+	const auto result = new entry(std::move(func), h);
+	result->next_hash = head;
+
+	while (!bucket.compare_exchange(head, result))
+	{
+		// Only check entries added concurrently
+		if (entry* found = find(result->data, h, head, result->next_hash))
+		{
+			delete result;
+			return {found, false};
+		}
+
+		result->next_hash = head;
+	}
+
+	// Add to the entry point index
+	auto& list = m_addrs[result->data.at(0) / 4 % m_addrs.size()];
+
+	result->next_addr = list;
+
+	while (!list.compare_exchange(result->next_addr, result))
+	{
+	}
+
+	m_inserts++;
+	return {result, true};
+}
+
+std::vector<spu_function_map::entry*> spu_function_map::get_all(u32 addr) const
+{
+	std::vector<entry*> result;
+
+	for (entry* e = m_addrs[addr / 4 % m_addrs.size()]; e; e = e->next_addr)
+	{
+		result.emplace_back(e);
+	}
+
+	// Same ordering as std::map<std::vector<u32>, ...> which is expected by trampoline generators
+	std::sort(result.begin(), result.end(), [](const entry* a, const entry* b)
+	{
+		return a->data < b->data;
+	});
+
+	return result;
+}
+
+spu_function_map::entry* spu_function_map::match(const be_t<u32>* ls, u32 addr) const
+{
+	const u32 start = addr * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
+
+	// Compare raw instruction data like the code check of compiled functions (zero words are not checked)
+	const auto code = reinterpret_cast<const u32*>(ls) + start / 4;
+
+	entry* result = nullptr;
+
+	for (entry* e = m_addrs[addr / 4 % m_addrs.size()]; e; e = e->next_addr)
+	{
+		if (!e->func || (result && e->data.size() <= result->data.size()) || start + e->data.size() * 4 - 4 > 0x40000)
+		{
+			continue;
+		}
 
-				ls[pos / 4] = 0;
-			}
+		bool ok = true;
 
-			if (func2.size() != size0)
+		for (u32 i = 1; i < e->data.size(); i++)
+		{
+			if (e->data[i] && e->data[i] != code[i - 1])
 			{
-				std::memset(ls.data(), 0, 0x40000);
+				ok = false;
+				break;
 			}
-
-			g_progr_pdone++;
 		}
 
-		if (Emu.IsStopped())
+		if (ok)
 		{
-			LOG_ERROR(SPU, "SPU Runtime: Cache building aborted.");
-			return;
+			result = e;
 		}
-
-		LOG_SUCCESS(SPU, "SPU Runtime: Built %u functions.", func_list.size());
 	}
 
-	// Register cache instance
-	fxm::import<spu_cache>([&]() -> std::shared_ptr<spu_cache>&&
-	{
-		return std::move(cache);
-	});
+	return result;
+}
+
+void spu_function_map::dump(std::string& out) const
+{
+	const u64 lookups = m_lookups;
+
+	fmt::append(out, "Functions: %u, lookups: %u, probes: %u (%.2f avg), comparisons: %u (%.2f avg)", m_inserts.load(), lookups,
+		m_probes.load(), lookups ? double(m_probes) / lookups : 0., m_compares.load(), lookups ? double(m_compares) / lookups : 0.);
 }
 
 spu_recompiler_base::spu_recompiler_base()
@@ -239,8 +1012,44 @@ void spu_recompiler_base::dispatch(spu_thread& spu, void*, u8* rip)
 		return;
 	}
 
+	// Look for a compiled function matching the code, analyse the block only on a true miss
+	// (the function checks its code and returns here through the dispatcher if it changes)
+	if (const auto fn = spu.jit->find(spu._ptr<u32>(0), spu.pc))
+	{
+		spu.jit_dispatcher[spu.pc / 4] = fn;
+		return;
+	}
+
+	if (g_cfg.core.spu_async_compile && g_cfg.core.spu_shared_runtime)
+	{
+		if (!spu.jit->m_queue)
+		{
+			spu.jit->m_queue = fxm::get_always<spu_compile_queue>();
+		}
+
+		if (!spu.jit->m_queue->is_pending(spu.pc))
+		{
+			auto data = spu.jit->block(spu._ptr<u32>(0), spu.pc);
+
+			if (!spu.jit->find(data))
+			{
+				spu.jit->m_queue->push(std::move(data));
+			}
+		}
+
+		// Don't wait for the compilation
+		spu.jit->m_queue->interpret(spu);
+		return;
+	}
+
 	// Compile
-	verify(HERE), spu.jit->compile(spu.jit->block(spu._ptr<u32>(0), spu.pc));
+	if (!spu.jit->compile(spu.jit->block(spu._ptr<u32>(0), spu.pc)))
+	{
+		// Compilation failed, interpret the block
+		spu_interpret_block(spu);
+		return;
+	}
+
 	spu.jit_dispatcher[spu.pc / 4] = spu.jit->get(spu.pc);
 
 	// Diagnostic
@@ -257,16 +1066,78 @@ void spu_recompiler_base::dispatch(spu_thread& spu, void*, u8* rip)
 
 void spu_recompiler_base::branch(spu_thread& spu, void*, u8* rip)
 {
-	// Compile (TODO: optimize search of the existing functions)
-	const auto func = verify(HERE, spu.jit->compile(spu.jit->block(spu._ptr<u32>(0), spu.pc)));
+	// Look for a compiled function matching the code, analyse the block only on a true miss
+	if (const auto fn = spu.jit->find(spu._ptr<u32>(0), spu.pc))
+	{
+		spu.jit_dispatcher[spu.pc / 4] = spu.jit->get(spu.pc);
+		patch(fn, rip);
+		return;
+	}
+
+	if (g_cfg.core.spu_async_compile && g_cfg.core.spu_shared_runtime)
+	{
+		// Patch the branch only when the function is ready
+		if (spu.jit->m_queue && spu.jit->m_queue->is_pending(spu.pc))
+		{
+			spu.jit->m_queue->interpret(spu);
+			return;
+		}
+
+		auto data = spu.jit->block(spu._ptr<u32>(0), spu.pc);
+
+		if (!spu.jit->find(data))
+		{
+			if (!spu.jit->m_queue)
+			{
+				spu.jit->m_queue = fxm::get_always<spu_compile_queue>();
+			}
+
+			spu.jit->m_queue->push(std::move(data));
+			spu.jit->m_queue->interpret(spu);
+			return;
+		}
+
+		spu.jit_dispatcher[spu.pc / 4] = spu.jit->get(spu.pc);
+		spu_recompiler_base::patch(spu.jit->compile(std::move(data)), rip);
+		return;
+	}
+
+	// Compile (existing functions are found in the lookup table without locking)
+	const auto func = spu.jit->compile(spu.jit->block(spu._ptr<u32>(0), spu.pc));
+
+	if (!func)
+	{
+		// Compilation failed, interpret the block and leave the branch unpatched
+		spu_interpret_block(spu);
+		return;
+	}
+
 	spu.jit_dispatcher[spu.pc / 4] = spu.jit->get(spu.pc);
 
+	patch(func, rip);
+}
+
+bool spu_recompiler_base::patch(spu_function_t func, u8* rip, u8* far)
+{
 	// Overwrite jump to this function with jump to the compiled function
-	const s64 rel = reinterpret_cast<u64>(func) - reinterpret_cast<u64>(rip) - 5;
+	s64 rel = reinterpret_cast<u64>(func) - reinterpret_cast<u64>(rip) - 5;
+
+	if ((rel < INT32_MIN || rel > INT32_MAX) && far)
+	{
+		// Set the address of the absolute jump and jump to it instead
+#ifdef _MSC_VER
+		*(volatile u64*)(far + 8) = reinterpret_cast<u64>(func);
+#else
+		__atomic_store_n(reinterpret_cast<u64*>(far + 8), reinterpret_cast<u64>(func), __ATOMIC_RELEASE);
+#endif
+		rel = reinterpret_cast<u64>(far) - reinterpret_cast<u64>(rip) - 5;
+	}
 
 	alignas(8) u8 bytes[8];
 
-	if (rel >= INT32_MIN && rel <= INT32_MAX)
+	const bool result = rel >= INT32_MIN && rel <= INT32_MAX;
+
+	if (result)
 	{
 		const s64 rel8 = (rel + 5) - 2;
 
@@ -285,7 +1156,7 @@ void spu_recompiler_base::branch(spu_thread& spu, void*, u8* rip)
 	}
 	else
 	{
-		// Far jumps: extremely rare and disabled due to implementation complexity
+		// Out of range without the far jump slot: fall through to the code after the patch point
 		bytes[0] = 0x0f; // nop (8-byte form)
 		bytes[1] = 0x1f;
 		bytes[2] = 0x84;
@@ -295,8 +1166,17 @@ void spu_recompiler_base::branch(spu_thread& spu, void*, u8* rip)
 #ifdef _MSC_VER
 	*(volatile u64*)(rip) = *reinterpret_cast<u64*>(+bytes);
 #else
-	__atomic_store_n(reinterpret_cast<u64*>(rip), *reinterpret_cast<u64*>(+bytes), __ATOMIC_RELAXED);
+	__atomic_store_n(reinterpret_cast<u64*>(rip), *reinterpret_cast<u64*>(+bytes), __ATOMIC_RELEASE);
 #endif
+
+	return result;
+}
+
+void spu_recompiler_base::promote(spu_thread&, void*, spu_function_map::entry* fn)
+{
+	fxm::get_always<spu_promote_queue>()->push(fn);
+
+	// Return to the dispatcher, PC is already set to the entry point
 }
 
 std::vector<u32> spu_recompiler_base::block(const be_t<u32>* ls, u32 entry_point)
@@ -1492,14 +2372,13 @@ void spu_recompiler_base::dump(std::string& out)
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/Vectorize.h"
-#include "Utilities/JIT.h"
 
 class spu_llvm_runtime
 {
 	shared_mutex m_mutex;
 
 	// All functions
-	std::map<std::vector<u32>, spu_function_t> m_map;
+	spu_function_map m_map;
 
 	// All dispatchers
 	std::array<atomic_t<spu_function_t>, 0x10000> m_dispatcher;
@@ -1510,31 +2389,22 @@ class spu_llvm_runtime
 	// Debug module output location
 	std::string m_cache_path;
 
-	friend class spu_llvm_recompiler;
-
-public:
-	spu_llvm_runtime()
-	{
-		// Initialize lookup table
-		for (auto& v : m_dispatcher)
-		{
-			v.raw() = &spu_recompiler_base::dispatch;
-		}
+	// Object cache location
+	std::string m_obj_path;
 
-		// Initialize "empty" block
-		m_map[std::vector<u32>()] = &spu_recompiler_base::dispatch;
+	// Object name suffix (settings affecting the generated code, host CPU)
+	std::string m_obj_suffix;
 
-		// Clear LLVM output
-		m_cache_path = fxm::check_unlocked<ppu_module>()->cache;
-		fs::create_dir(m_cache_path + "llvm/");
-		fs::remove_all(m_cache_path + "llvm/", false);
+	friend class spu_llvm_recompiler;
 
-		if (g_cfg.core.spu_debug)
-		{
-			fs::file(m_cache_path + "spu.log", fs::rewrite);
-		}
+public:
+	spu_llvm_runtime();
 
-		LOG_SUCCESS(SPU, "SPU Recompiler Runtime (LLVM) initialized...");
+	~spu_llvm_runtime()
+	{
+		std::string stats;
+		m_map.dump(stats);
+		LOG_NOTICE(SPU, "SPU Recompiler Runtime (LLVM): %s", stats);
 	}
 };
 
@@ -1551,7 +2421,7 @@ class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
 	llvm::Value* m_thread;
 	llvm::Value* m_lsptr;
 
-	// i8*, contains constant vm::g_base_addr value
+	// i8*, contains vm::g_base_addr value (computed from the LS pointer)
 	llvm::Value* m_memptr;
 
 	// Pointers to registers in the thread context
@@ -1673,7 +2543,10 @@ class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
 		m_blocks.clear();
 		m_block_queue.clear();
 		m_ir->SetInsertPoint(llvm::BasicBlock::Create(m_context, "", m_function));
-		m_memptr = m_ir->CreateIntToPtr(m_ir->getInt64((u64)vm::g_base_addr), get_type<u8*>());
+
+		// Compute memory base from the LS pointer (no absolute addresses in cached objects)
+		const auto ls_off = m_ir->CreateZExt(m_ir->CreateLoad(spu_ptr<u32>(&spu_thread::offset)), get_type<u64>());
+		m_memptr = m_ir->CreateGEP(m_lsptr, m_ir->CreateNeg(ls_off));
 	}
 
 	// Add block with current block as a predecessor
@@ -2202,14 +3075,23 @@ class spu_llvm_recompiler : public spu_recompiler_base, public cpu_translator
 		m_ir->SetInsertPoint(_body);
 	}
 
-	// Perform external call
+	// Perform external call (function must be registered in s_link_table)
 	template <typename RT, typename... FArgs, typename... Args>
 	llvm::CallInst* call(RT(*_func)(FArgs...), Args... args)
 	{
 		static_assert(sizeof...(FArgs) == sizeof...(Args), "spu_llvm_recompiler::call(): unexpected arg number");
 		const auto iptr = reinterpret_cast<std::uintptr_t>(_func);
-		const auto type = llvm::FunctionType::get(get_type<RT>(), {args->getType()...}, false)->getPointerTo();
-		return m_ir->CreateCall(m_ir->CreateIntToPtr(m_ir->getInt64(iptr), type), {args...});
+		const auto type = llvm::FunctionType::get(get_type<RT>(), {args->getType()...}, false);
+
+		for (const auto& pair : s_link_table)
+		{
+			if (pair.second == iptr)
+			{
+				return m_ir->CreateCall(m_module->getOrInsertFunction(pair.first, type), {args...});
+			}
+		}
+
+		fmt::throw_exception("Unregistered external function (0x%x)" HERE, iptr);
 	}
 
 	// Perform external call and return
@@ -2267,10 +3149,43 @@ public:
 		return m_spurt->m_dispatcher[lsa / 4];
 	}
 
+	virtual spu_function_t find(const std::vector<u32>& func) override
+	{
+		init();
+
+		if (const auto found = m_spurt->m_map.find(func))
+		{
+			return found->func;
+		}
+
+		return nullptr;
+	}
+
+	virtual spu_function_t find(const be_t<u32>* ls, u32 addr) override
+	{
+		init();
+
+		if (const auto found = m_spurt->m_map.match(ls, addr))
+		{
+			return found->func;
+		}
+
+		return nullptr;
+	}
+
 	virtual spu_function_t compile(std::vector<u32>&& func_rv) override
 	{
 		init();
 
+		// Try to find existing function without locking
+		if (const auto found = m_spurt->m_map.find(func_rv))
+		{
+			if (const auto fn = found->func.load())
+			{
+				return fn;
+			}
+		}
+
 		// Don't lock without shared runtime
 		std::unique_lock lock(m_spurt->m_mutex, std::defer_lock);
 
@@ -2280,16 +3195,16 @@ public:
 		}
 
 		// Try to find existing function, register new one if necessary
-		const auto fn_info = m_spurt->m_map.emplace(std::move(func_rv), nullptr);
+		const auto fn_info = m_spurt->m_map.emplace(std::move(func_rv));
 
-		auto& fn_location = fn_info.first->second;
+		auto& fn_location = fn_info.first->func;
 
-		if (fn_location)
+		if (const auto fn = fn_location.load())
 		{
-			return fn_location;
+			return fn;
 		}
 
-		auto& func = fn_info.first->first;
+		auto& func = fn_info.first->data;
 
 		std::string hash;
 		{
@@ -2361,10 +3276,27 @@ public:
 			m_cache->add(func);
 		}
 
+		// Object file name: content hash, settings and host CPU
+		const std::string obj_name = fmt::format("v1-%s-%s.obj", hash, m_spurt->m_obj_suffix);
+
+		if (g_cfg.core.spu_cache && fs::is_file(m_spurt->m_obj_path + obj_name))
+		{
+			// Load precompiled function, skip translation
+			m_spurt->m_jit.add(m_spurt->m_obj_path + obj_name);
+			m_spurt->m_jit.fin();
+
+			if (const auto fn = reinterpret_cast<spu_function_t>(m_spurt->m_jit.get(hash)))
+			{
+				return finalize(fn_info.first, fn);
+			}
+
+			LOG_ERROR(SPU, "LLVM: Failed to load %s", obj_name);
+		}
+
 		using namespace llvm;
 
 		// Create LLVM module
-		std::unique_ptr<Module> module = std::make_unique<Module>(hash + ".obj", m_context);
+		std::unique_ptr<Module> module = std::make_unique<Module>(obj_name, m_context);
 		module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
 		m_module = module.get();
 
@@ -2771,16 +3703,99 @@ public:
 		m_scan_queue.clear();
 		m_function_table = nullptr;
 
-		// Generate a dispatcher (übertrampoline)
-		std::vector<u32> addrv{func[0]};
-		const auto beg = m_spurt->m_map.lower_bound(addrv);
-		addrv[0] += 4;
-		const auto _end = m_spurt->m_map.lower_bound(addrv);
-		const u32 size0 = std::distance(beg, _end);
+		if (g_cfg.core.spu_cache)
+		{
+			add_module(std::move(module), m_spurt->m_obj_path);
+		}
+		else if (g_cfg.core.spu_debug)
+		{
+			// Testing only
+			add_module(std::move(module), m_spurt->m_cache_path + "llvm/");
+		}
+		else
+		{
+			add_module(std::move(module), {});
+		}
+
+		return finalize(fn_info.first, reinterpret_cast<spu_function_t>(m_spurt->m_jit.get_engine().getPointerToFunction(main_func)));
+	}
+
+	// Verify and compile the module (save the object if the path is not empty)
+	void add_module(std::unique_ptr<llvm::Module> module, const std::string& path)
+	{
+		using namespace llvm;
+
+		std::string log;
+
+		raw_string_ostream out(log);
+
+		if (g_cfg.core.spu_debug)
+		{
+			fmt::append(log, "LLVM IR (%s):\n", module->getName().str());
+			out << *module; // print IR
+			out << "\n\n";
+		}
+
+		if (verifyModule(*module, &out))
+		{
+			out.flush();
+			LOG_ERROR(SPU, "LLVM: Verification failed (%s):\n%s", module->getName().str(), log);
+
+			if (g_cfg.core.spu_debug)
+			{
+				fs::file(m_spurt->m_cache_path + "spu.log", fs::write + fs::append).write(log);
+			}
+
+			fmt::raw_error("Compilation failed");
+		}
+
+		if (path.empty())
+		{
+			m_spurt->m_jit.add(std::move(module));
+		}
+		else
+		{
+			m_spurt->m_jit.add(std::move(module), path);
+		}
+
+		m_spurt->m_jit.fin();
+
+		if (g_cfg.core.spu_debug)
+		{
+			out.flush();
+			fs::file(m_spurt->m_cache_path + "spu.log", fs::write + fs::append).write(log);
+		}
+	}
+
+	// Register compiled function and generate a dispatcher (übertrampoline)
+	spu_function_t finalize(spu_function_map::entry* entry, spu_function_t fn)
+	{
+		using namespace llvm;
+
+		const auto& func = entry->data;
+		const u32 start = func[0] * (g_cfg.core.spu_block_size != spu_block_size_type::giga);
+
+		// Register function pointer
+		entry->func = fn;
+
+		spu_function_t tr = fn;
+
+		const auto all = m_spurt->m_map.get_all(func[0]);
+		const auto beg = all.cbegin();
+		const auto _end = all.cend();
+		const u32 size0 = ::size32(all);
 
 		if (size0 > 1)
 		{
-			const auto trampoline = cast<Function>(module->getOrInsertFunction(fmt::format("spu-0x%05x-trampoline-%03u", func[0], size0), get_type<void>(), get_type<u8*>(), get_type<u8*>()));
+			// Separate module, not cached: the trampoline refers to other functions by address
+			std::unique_ptr<Module> module = std::make_unique<Module>(fmt::format("spu-0x%05x-trampoline-%03u", func[0], size0), m_context);
+			module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
+			m_module = module.get();
+
+			IRBuilder<> irb(m_context);
+			m_ir = &irb;
+
+			const auto trampoline = cast<Function>(module->getOrInsertFunction(module->getName(), get_type<void>(), get_type<u8*>(), get_type<u8*>()));
 			set_function(trampoline);
 
 			struct work
@@ -2788,8 +3803,8 @@ public:
 				u32 size;
 				u32 level;
 				BasicBlock* label;
-				std::map<std::vector<u32>, spu_function_t>::iterator beg;
-				std::map<std::vector<u32>, spu_function_t>::iterator end;
+				std::vector<spu_function_map::entry*>::const_iterator beg;
+				std::vector<spu_function_map::entry*>::const_iterator end;
 			};
 
 			std::vector<work> workload;
@@ -2813,9 +3828,9 @@ public:
 
 				bool unsorted = false;
 
-				while (w.level < w.beg->first.size())
+				while (w.level < (*w.beg)->data.size())
 				{
-					const u32 x1 = w.beg->first.at(w.level);
+					const u32 x1 = (*w.beg)->data.at(w.level);
 
 					if (x1 == 0)
 					{
@@ -2823,7 +3838,7 @@ public:
 						auto it = w.end;
 						it--;
 
-						if (it->first.at(w.level) != 0)
+						if ((*it)->data.at(w.level) != 0)
 						{
 							unsorted = true;
 						}
@@ -2841,7 +3856,7 @@ public:
 					{
 						it2++;
 
-						const u32 x2 = it2 != w.end ? it2->first.at(w.level) : x1;
+						const u32 x2 = it2 != w.end ? (*it2)->data.at(w.level) : x1;
 
 						if (x2 != x)
 						{
@@ -2853,15 +3868,14 @@ public:
 							{
 								m_ir->SetInsertPoint(b);
 
-								if (const u64 fval = reinterpret_cast<u64>(it->second))
+								if (const u64 fval = reinterpret_cast<u64>((*it)->func.load()))
 								{
-									const auto ptr = m_ir->CreateIntToPtr(m_ir->getInt64(fval), main_func->getType());
+									const auto ptr = m_ir->CreateIntToPtr(m_ir->getInt64(fval), trampoline->getType());
 									m_ir->CreateCall(ptr, {m_thread, m_lsptr})->setTailCall();
 								}
 								else
 								{
-									verify(HERE, &it->second == &fn_location);
-									m_ir->CreateCall(main_func, {m_thread, m_lsptr})->setTailCall();
+									call(&spu_recompiler_base::dispatch, m_thread, m_ir->getInt32(0), m_ir->getInt32(0))->setTailCall();
 								}
 
 								m_ir->CreateRetVoid();
@@ -2906,15 +3920,14 @@ public:
 					LOG_ERROR(SPU, "Trampoline simplified at 0x%x (level=%u)", func[0], w.level);
 					m_ir->SetInsertPoint(w.label);
 
-					if (const u64 fval = reinterpret_cast<u64>(w.beg->second))
+					if (const u64 fval = reinterpret_cast<u64>((*w.beg)->func.load()))
 					{
-						const auto ptr = m_ir->CreateIntToPtr(m_ir->getInt64(fval), main_func->getType());
+						const auto ptr = m_ir->CreateIntToPtr(m_ir->getInt64(fval), trampoline->getType());
 						m_ir->CreateCall(ptr, {m_thread, m_lsptr})->setTailCall();
 					}
 					else
 					{
-						verify(HERE, &w.beg->second == &fn_location);
-						m_ir->CreateCall(main_func, {m_thread, m_lsptr})->setTailCall();
+						call(&spu_recompiler_base::dispatch, m_thread, m_ir->getInt32(0), m_ir->getInt32(0))->setTailCall();
 					}
 
 					m_ir->CreateRetVoid();
@@ -2940,56 +3953,11 @@ public:
 					sw->addCase(m_ir->getInt32(pair.first), pair.second);
 				}
 			}
-		}
-
-		spu_function_t fn{}, tr{};
-
-		std::string log;
-
-		raw_string_ostream out(log);
-
-		if (g_cfg.core.spu_debug)
-		{
-			fmt::append(log, "LLVM IR at 0x%x:\n", func[0]);
-			out << *module; // print IR
-			out << "\n\n";
-		}
-
-		if (verifyModule(*module, &out))
-		{
-			out.flush();
-			LOG_ERROR(SPU, "LLVM: Verification failed at 0x%x:\n%s", func[0], log);
-
-			if (g_cfg.core.spu_debug)
-			{
-				fs::file(m_spurt->m_cache_path + "spu.log", fs::write + fs::append).write(log);
-			}
-
-			fmt::raw_error("Compilation failed");
-		}
-
-		if (g_cfg.core.spu_debug)
-		{
-			// Testing only
-			m_spurt->m_jit.add(std::move(module), m_spurt->m_cache_path + "llvm/");
-		}
-		else
-		{
-			m_spurt->m_jit.add(std::move(module));
-		}
-
-		m_spurt->m_jit.fin();
-		fn = reinterpret_cast<spu_function_t>(m_spurt->m_jit.get_engine().getPointerToFunction(main_func));
-		tr = fn;
 
-		if (size0 > 1)
-		{
-			tr = reinterpret_cast<spu_function_t>(m_spurt->m_jit.get_engine().getPointerToFunction(m_function));
+			add_module(std::move(module), {});
+			tr = reinterpret_cast<spu_function_t>(m_spurt->m_jit.get_engine().getPointerToFunction(trampoline));
 		}
 
-		// Register function pointer
-		fn_location = fn;
-
 		// Trampoline
 		m_spurt->m_dispatcher[func[0] / 4] = tr;
 
@@ -2998,12 +3966,6 @@ public:
 		if (tr != fn)
 			LOG_NOTICE(SPU, "[0x%x] T: %p", func[0], tr);
 
-		if (g_cfg.core.spu_debug)
-		{
-			out.flush();
-			fs::file(m_spurt->m_cache_path + "spu.log", fs::write + fs::append).write(log);
-		}
-
 		return fn;
 	}
 
@@ -5734,8 +6696,63 @@ public:
 	}
 
 	static const spu_decoder<spu_llvm_recompiler> g_decoder;
+
+	// External functions called from the generated code (name -> address)
+	static const std::unordered_map<std::string, u64> s_link_table;
+};
+
+const std::unordered_map<std::string, u64> spu_llvm_recompiler::s_link_table
+{
+	{ "__spu_dispatch", (u64)&spu_recompiler_base::dispatch },
+	{ "__spu_get_tb", (u64)&get_timebased_time },
+	{ "__spu_check_state", (u64)&exec_check_state },
+	{ "__spu_check_interrupts", (u64)&exec_check_interrupts },
+	{ "__spu_unk", (u64)&exec_unk },
+	{ "__spu_stop", (u64)&exec_stop },
+	{ "__spu_rdch", (u64)&exec_rdch },
+	{ "__spu_read_in_mbox", (u64)&exec_read_in_mbox },
+	{ "__spu_read_dec", (u64)&exec_read_dec },
+	{ "__spu_read_events", (u64)&exec_read_events },
+	{ "__spu_rchcnt", (u64)&exec_rchcnt },
+	{ "__spu_get_events", (u64)&exec_get_events },
+	{ "__spu_wrch", (u64)&exec_wrch },
+	{ "__spu_mfc", (u64)&exec_mfc },
+	{ "__spu_mfc_cmd", (u64)&exec_mfc_cmd },
 };
 
+spu_llvm_runtime::spu_llvm_runtime()
+{
+	// Initialize lookup table
+	for (auto& v : m_dispatcher)
+	{
+		v.raw() = &spu_recompiler_base::dispatch;
+	}
+
+	// Clear LLVM output
+	m_cache_path = fxm::check_unlocked<ppu_module>()->cache;
+	fs::create_dir(m_cache_path + "llvm/");
+	fs::remove_all(m_cache_path + "llvm/", false);
+
+	if (g_cfg.core.spu_debug)
+	{
+		fs::file(m_cache_path + "spu.log", fs::rewrite);
+	}
+
+	// Objects are only valid for the same settings and the same host CPU
+	m_obj_path = m_cache_path + "spu-llvm/";
+	fs::create_dir(m_obj_path);
+	m_obj_suffix = fmt::format("%s%s%s-%s", fmt::to_lower(g_cfg.core.spu_block_size.to_string()),
+		g_cfg.core.spu_accurate_xfloat ? "-xf" : "", g_cfg.core.spu_verification ? "" : "-nv", jit_compiler::cpu(g_cfg.core.llvm_cpu));
+
+	// Generated code calls external functions by name
+	for (const auto& pair : spu_llvm_recompiler::s_link_table)
+	{
+		m_jit.add_symbol(pair.first, pair.second);
+	}
+
+	LOG_SUCCESS(SPU, "SPU Recompiler Runtime (LLVM) initialized...");
+}
+
 std::unique_ptr<spu_recompiler_base> spu_recompiler_base::make_llvm_recompiler()
 {
 	return std::make_unique<spu_llvm_recompiler>();
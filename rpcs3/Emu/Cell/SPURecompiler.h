@@ -1,19 +1,45 @@
 #pragma once
 
 #include "Utilities/File.h"
+#include "Utilities/mutex.h"
 #include "SPUThread.h"
 #include <vector>
 #include <bitset>
 #include <memory>
 #include <string>
-#include <deque>
+#include <unordered_map>
 
 // Helper class
 class spu_cache
 {
 	fs::file m_file;
 
+	// Mapped file contents (valid records at the time of opening)
+	fs::file_view m_view;
+
+	// Index of stored functions (entry point and body hash -> record offsets)
+	std::unordered_multimap<u64, u64> m_index;
+
+	// End of the last valid record
+	u64 m_end = 0;
+
+	shared_mutex m_mutex;
+
+	// Find duplicate (must be locked)
+	bool find(u64 key, u32 addr, const u32* data, u32 size);
+
 public:
+	// Function record reference (points into the mapped file)
+	struct func_view
+	{
+		u32 addr;
+		u32 size;
+		const u32* data;
+
+		// Get function data in the compiler format (addr + raw instruction data)
+		std::vector<u32> get() const;
+	};
+
 	spu_cache(const std::string& loc);
 
 	~spu_cache();
@@ -23,13 +49,95 @@ public:
 		return m_file.operator bool();
 	}
 
-	std::deque<std::vector<u32>> get();
+	// Get all valid functions (most recently added first)
+	std::vector<func_view> get();
 
+	// Add function if it's not already present
 	void add(const std::vector<u32>& func);
 
+	// Get 64-bit hash of the function (entry point and SHA-1 of the data)
+	static u64 hash(u32 addr, const u32* data, u32 size);
+
 	static void initialize();
 };
 
+// Compiled SPU function lookup table (keyed by entry point and content hash)
+class spu_function_map
+{
+public:
+	struct entry
+	{
+		// Entry point + raw instruction data
+		const std::vector<u32> data;
+
+		// Content hash
+		const u64 hash;
+
+		// Compiled function (null if not compiled yet)
+		atomic_t<spu_function_t> func{nullptr};
+
+		// Set if the compilation failed (func stays null, the block is interpreted)
+		atomic_t<bool> failed{false};
+
+		// Entry counter (atomically incremented by generated code in tiered mode)
+		atomic_t<u64> hits{0};
+
+		// Next entry in the same hash bucket
+		entry* next_hash = nullptr;
+
+		// Next entry with the same entry point
+		entry* next_addr = nullptr;
+
+		entry(std::vector<u32>&& _data, u64 _hash)
+			: data(std::move(_data))
+			, hash(_hash)
+		{
+		}
+	};
+
+private:
+	// Hash buckets (entries are never removed, readers don't lock)
+	std::array<atomic_t<entry*>, 0x8000> m_buckets{};
+
+	// Entry point index
+	std::array<atomic_t<entry*>, 0x10000> m_addrs{};
+
+	// Statistics
+	atomic_t<u64> m_lookups{0};
+	atomic_t<u64> m_probes{0};
+	atomic_t<u64> m_compares{0};
+	atomic_t<u64> m_inserts{0};
+
+	entry* find(const std::vector<u32>& func, u64 hash, entry* head, entry* stop);
+
+public:
+	spu_function_map() = default;
+
+	spu_function_map(const spu_function_map&) = delete;
+
+	spu_function_map& operator=(const spu_function_map&) = delete;
+
+	~spu_function_map();
+
+	// Compute content hash (entry point included)
+	static u64 hash(const std::vector<u32>& func);
+
+	// Find existing function
+	entry* find(const std::vector<u32>& func);
+
+	// Find existing function or add new one (returns true if added)
+	std::pair<entry*, bool> emplace(std::vector<u32>&& func);
+
+	// Get all functions with given entry point, sorted by content
+	std::vector<entry*> get_all(u32 addr) const;
+
+	// Find the largest compiled function matching the local storage at given entry point (without analysis)
+	entry* match(const be_t<u32>* ls, u32 addr) const;
+
+	// Print lookup statistics
+	void dump(std::string& out) const;
+};
+
 // SPU Recompiler instance base class
 class spu_recompiler_base
 {
@@ -57,6 +165,9 @@ protected:
 
 	std::shared_ptr<spu_cache> m_cache;
 
+	// Background compilation queue (async mode)
+	std::shared_ptr<class spu_compile_queue> m_queue;
+
 private:
 	// For private use
 	std::bitset<0x10000> m_bits;
@@ -75,12 +186,25 @@ public:
 	// Compile function
 	virtual spu_function_t compile(std::vector<u32>&&) = 0;
 
+	// Find compiled function (returns null if not compiled yet)
+	virtual spu_function_t find(const std::vector<u32>&) = 0;
+
+	// Find compiled function matching the local storage at given entry point (returns null if not found)
+	virtual spu_function_t find(const be_t<u32>* ls, u32 addr) = 0;
+
 	// Default dispatch function fallback (second arg is unused)
 	static void dispatch(spu_thread&, void*, u8* rip);
 
 	// Target for the unresolved patch point (second arg is unused)
 	static void branch(spu_thread&, void*, u8* rip);
 
+	// Overwrite the patch point with a jump to the compiled function, returns false if it's out of range
+	// (far: optional 16-byte slot with an absolute jump, used if the function is out of rel32 range)
+	static bool patch(spu_function_t func, u8* rip, u8* far = nullptr);
+
+	// Queue hot function for recompilation with LLVM (tiered mode)
+	static void promote(spu_thread&, void*, spu_function_map::entry* fn);
+
 	// Get the block at specified address
 	std::vector<u32> block(const be_t<u32>* ls, u32 lsa);
 
@@ -477,6 +477,7 @@ void spu_thread::cpu_init()
 }
 
 extern thread_local std::string(*g_tls_log_prefix)();
+extern thread_local logs::raw_prefix(*g_tls_log_raw_prefix)();
 
 void spu_thread::cpu_task()
 {
@@ -501,6 +502,12 @@ void spu_thread::cpu_task()
 		return fmt::format("%s [0x%05x]", thread_ctrl::get_name(), cpu->pc);
 	};
 
+	g_tls_log_raw_prefix = []
+	{
+		const auto cpu = static_cast<spu_thread*>(get_current_cpu_thread());
+		return logs::raw_prefix{thread_ctrl::get_name(), cpu->pc, 5};
+	};
+
 	if (jit)
 	{
 		while (LIKELY(!state || !check_state()))
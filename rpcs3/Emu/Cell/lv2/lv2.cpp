@@ -1001,6 +1001,7 @@ DECLARE(lv2_obj::g_mutex);
 DECLARE(lv2_obj::g_ppu);
 DECLARE(lv2_obj::g_pending);
 DECLARE(lv2_obj::g_waiting);
+DECLARE(lv2_obj::g_timeouts);
 
 void lv2_obj::sleep_timeout(cpu_thread& thread, u64 timeout)
 {
@@ -1030,7 +1031,7 @@ void lv2_obj::sleep_timeout(cpu_thread& thread, u64 timeout)
 		}
 
 		// Find and remove the thread
-		unqueue(g_ppu, ppu);
+		g_ppu.remove(ppu, ppu->prio);
 		unqueue(g_pending, ppu);
 
 		ppu->start_time = start_time;
@@ -1040,17 +1041,15 @@ void lv2_obj::sleep_timeout(cpu_thread& thread, u64 timeout)
 	{
 		const u64 wait_until = start_time + timeout;
 
-		// Register timeout if necessary
-		for (auto it = g_waiting.begin(), end = g_waiting.end(); it != end; it++)
+		// Register timeout (replaces the previous one)
+		remove_timeout(thread);
+		g_waiting.emplace(wait_until, &thread);
+		g_timeouts.emplace(&thread, wait_until);
+
+		if (const auto service = fxm::check<lv2_timer_service>())
 		{
-			if (it->first > wait_until)
-			{
-				g_waiting.emplace(it, wait_until, &thread);
-				return;
-			}
+			service->wake(wait_until);
 		}
-
-		g_waiting.emplace_back(wait_until, &thread);
 	}
 
 	schedule_all();
@@ -1061,67 +1060,48 @@ void lv2_obj::awake(cpu_thread& cpu, u32 prio)
 	// Check thread type
 	if (cpu.id_type() != 1) return;
 
+	auto& ppu = static_cast<ppu_thread&>(cpu);
+
 	std::lock_guard lock(g_mutex);
 
 	if (prio < INT32_MAX)
 	{
-        // Priority set
-        if (static_cast<ppu_thread&>(cpu).prio.exchange(prio) == prio || !unqueue(g_ppu, &cpu))
-        {
-            return;
-        }
+		// Priority set
+		const u32 old_prio = ppu.prio.exchange(prio);
+
+		if (old_prio == prio || !g_ppu.remove(&ppu, old_prio))
+		{
+			return;
+		}
 	}
 	else if (prio == -4)
 	{
 		// Yield command
 		const u64 start_time = get_system_time();
 
-		for (std::size_t i = 0, pos = -1; i < g_ppu.size(); i++)
+		if (g_ppu.is_last(&ppu, ppu.prio))
 		{
-			if (g_ppu[i] == &cpu)
-			{
-				pos = i;
-				prio = g_ppu[i]->prio;
-			}
-			else if (i == pos + 1 && prio != -4 && g_ppu[i]->prio != prio)
-			{
-				return;
-			}
+			// No other threads with the same priority to yield to
+			return;
 		}
 
-		unqueue(g_ppu, &cpu);
+		g_ppu.remove(&ppu, ppu.prio);
 		unqueue(g_pending, &cpu);
 
-		static_cast<ppu_thread&>(cpu).start_time = start_time;
+		ppu.start_time = start_time;
 	}
 
-	// Emplace current thread
-	for (std::size_t i = 0; i <= g_ppu.size(); i++)
+	// Emplace current thread, use priority, also preserve FIFO order
+	if (g_ppu.push(&ppu, ppu.prio))
 	{
-		if (i < g_ppu.size() && g_ppu[i] == &cpu)
-		{
-			LOG_TRACE(PPU, "sleep() - suspended (p=%zu)", g_pending.size());
-			break;
-		}
+		LOG_TRACE(PPU, "awake(): %s", cpu.id);
 
-		// Use priority, also preserve FIFO order
-		if (i == g_ppu.size() || g_ppu[i]->prio > static_cast<ppu_thread&>(cpu).prio)
-		{
-			LOG_TRACE(PPU, "awake(): %s", cpu.id);
-			g_ppu.insert(g_ppu.cbegin() + i, &static_cast<ppu_thread&>(cpu));
-
-			// Unregister timeout if necessary
-			for (auto it = g_waiting.cbegin(), end = g_waiting.cend(); it != end; it++)
-			{
-				if (it->second == &cpu)
-				{
-					g_waiting.erase(it);
-					break;
-				}
-			}
-
-			break;
-		}
+		// Unregister timeout if necessary
+		remove_timeout(cpu);
+	}
+	else
+	{
+		LOG_TRACE(PPU, "sleep() - suspended (p=%zu)", g_pending.size());
 	}
 
 	// Remove pending if necessary
@@ -1131,25 +1111,37 @@ void lv2_obj::awake(cpu_thread& cpu, u32 prio)
 	}
 
 	// Suspend threads if necessary
-	for (std::size_t i = g_cfg.core.ppu_threads; i < g_ppu.size(); i++)
+	g_ppu.for_each(g_cfg.core.ppu_threads, [](ppu_thread* target)
 	{
-		const auto target = g_ppu[i];
-
 		if (!target->state.test_and_set(cpu_flag::suspend))
 		{
 			LOG_TRACE(PPU, "suspend(): %s", target->id);
 			g_pending.emplace_back(target);
 		}
-	}
+
+		return true;
+	});
 
 	schedule_all();
 }
 
+void lv2_obj::remove_timeout(cpu_thread& cpu)
+{
+	if (const auto found = g_timeouts.find(&cpu); found != g_timeouts.end())
+	{
+		g_waiting.erase(std::make_pair(found->second, &cpu));
+		g_timeouts.erase(found);
+	}
+}
+
 void lv2_obj::cleanup()
 {
+	std::lock_guard lock(g_mutex);
+
 	g_ppu.clear();
 	g_pending.clear();
 	g_waiting.clear();
+	g_timeouts.clear();
 }
 
 void lv2_obj::schedule_all()
@@ -1157,10 +1149,10 @@ void lv2_obj::schedule_all()
 	if (g_pending.empty())
 	{
 		// Wake up threads
-		for (std::size_t i = 0, x = std::min<std::size_t>(g_cfg.core.ppu_threads, g_ppu.size()); i < x; i++)
-		{
-			const auto target = g_ppu[i];
+		std::size_t count = g_cfg.core.ppu_threads;
 
+		g_ppu.for_each(0, [&](ppu_thread* target)
+		{
 			if (target->state & cpu_flag::suspend)
 			{
 				LOG_TRACE(PPU, "schedule(): %s", target->id);
@@ -1172,23 +1164,40 @@ void lv2_obj::schedule_all()
 					target->notify();
 				}
 			}
-		}
+
+			return --count != 0;
+		});
 	}
 
 	// Check registered timeouts
+	notify_timeouts();
+}
+
+u64 lv2_obj::notify_timeouts()
+{
 	while (!g_waiting.empty())
 	{
-		auto& pair = g_waiting.front();
+		const auto pair = *g_waiting.begin();
 
 		if (pair.first <= get_system_time())
 		{
 			pair.second->notify();
-			g_waiting.pop_front();
+			g_waiting.erase(g_waiting.begin());
+			g_timeouts.erase(pair.second);
 		}
 		else
 		{
 			// The list is sorted so assume no more timeouts
-			break;
+			return pair.first;
 		}
 	}
+
+	return UINT64_MAX;
+}
+
+u64 lv2_obj::check_timeouts()
+{
+	std::lock_guard lock(g_mutex);
+
+	return notify_timeouts();
 }
@@ -64,21 +64,126 @@ lv2_fs_mount_point* lv2_fs_object::get_mp(const char* filename)
 	return &g_mp_sys_dev_hdd0;
 }
 
+// Bytes transferred directly between files and guest memory
+static atomic_t<u64> s_fs_direct_bytes{0};
+
+// Bytes transferred through the intermediate buffer
+static atomic_t<u64> s_fs_copied_bytes{0};
+
+// Log and reset I/O statistics (called on emulation stop)
+void lv2_fs_report_stats()
+{
+	const u64 direct = s_fs_direct_bytes.exchange(0);
+	const u64 copied = s_fs_copied_bytes.exchange(0);
+
+	if (direct || copied)
+	{
+		sys_fs.notice("I/O statistics: %u bytes transferred directly, %u bytes through the intermediate buffer", direct, copied);
+	}
+}
+
+// Intermediate buffer size limit (larger requests are processed in chunks)
+static constexpr u64 s_fs_bounce_max = 0x100000;
+
+// Reusable per-thread intermediate buffer
+static thread_local std::vector<u8> s_fs_bounce_buf;
+
+static u8* fs_bounce_buffer(u64 size)
+{
+	if (s_fs_bounce_buf.size() < size)
+	{
+		s_fs_bounce_buf.resize(size);
+	}
+
+	return s_fs_bounce_buf.data();
+}
+
+// Check whether guest memory range can be accessed directly via the sudo mirror
+static bool fs_check_direct(u32 addr, u64 size, u8 flags)
+{
+	if (size == 0 || size > 0x100000000 - addr)
+	{
+		return false;
+	}
+
+	return vm::check_addr(addr, static_cast<u32>(size), flags | vm::page_allocated);
+}
+
 u64 lv2_file::op_read(vm::ptr<void> buf, u64 size)
 {
+	const u32 addr = buf.addr();
+
+	if (fs_check_direct(addr, size, vm::page_readable | vm::page_writable))
+	{
+		// Touch every page for writing so that the access violation handler can invalidate the cached data (RSX)
+		for (u32 i = addr / 4096; i <= (addr + size - 1) / 4096; i++)
+		{
+			atomic_storage<u8>::fetch_or(*vm::_ptr<u8>(std::max<u32>(i * 4096, addr)), 0);
+		}
+
+		// Read into the sudo mirror (avoid passing a possibly protected pointer to a native API)
+		const u64 result = file.read(vm::get_super_ptr(addr), size);
+		s_fs_direct_bytes += result;
+		return result;
+	}
+
 	// Copy data from intermediate buffer (avoid passing vm pointer to a native API)
-	std::unique_ptr<u8[]> local_buf(new u8[size]);
-	const u64 result = file.read(local_buf.get(), size);
-	std::memcpy(buf.get_ptr(), local_buf.get(), result);
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u64 chunk = std::min<u64>(size - result, s_fs_bounce_max);
+		const auto local_buf = fs_bounce_buffer(chunk);
+		const u64 count = file.read(local_buf, chunk);
+		std::memcpy(static_cast<u8*>(buf.get_ptr()) + result, local_buf, count);
+		result += count;
+
+		if (count < chunk)
+		{
+			break;
+		}
+	}
+
+	s_fs_copied_bytes += result;
 	return result;
 }
 
 u64 lv2_file::op_write(vm::cptr<void> buf, u64 size)
 {
+	const u32 addr = buf.addr();
+
+	if (fs_check_direct(addr, size, vm::page_readable))
+	{
+		// Touch every page for reading so that the access violation handler can flush the cached data (RSX)
+		for (u32 i = addr / 4096; i <= (addr + size - 1) / 4096; i++)
+		{
+			static_cast<void>(*static_cast<const volatile u8*>(vm::base(std::max<u32>(i * 4096, addr))));
+		}
+
+		const u64 result = file.write(vm::get_super_ptr(addr), size);
+		s_fs_direct_bytes += result;
+		return result;
+	}
+
 	// Copy data to intermediate buffer (avoid passing vm pointer to a native API)
-	std::unique_ptr<u8[]> local_buf(new u8[size]);
-	std::memcpy(local_buf.get(), buf.get_ptr(), size);
-	return file.write(local_buf.get(), size);
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u64 chunk = std::min<u64>(size - result, s_fs_bounce_max);
+		const auto local_buf = fs_bounce_buffer(chunk);
+		std::memcpy(local_buf, static_cast<const u8*>(buf.get_ptr()) + result, chunk);
+		const u64 count = file.write(local_buf, chunk);
+		result += count;
+
+		if (count < chunk)
+		{
+			break;
+		}
+	}
+
+	s_fs_copied_bytes += result;
+	return result;
 }
 
 struct lv2_file::file_view : fs::file_base
@@ -110,6 +215,8 @@ struct lv2_file::file_view : fs::file_base
 
 	u64 read(void* buffer, u64 size) override
 	{
+		std::lock_guard lock(m_file->mutex);
+
 		const u64 old_pos = m_file->file.pos();
 		const u64 new_pos = m_file->file.seek(m_off + m_pos);
 		const u64 result = m_file->file.read(buffer, size);
@@ -402,6 +509,7 @@ error_code sys_fs_read(u32 fd, vm::ptr<void> buf, u64 nbytes, vm::ptr<u64> nread
 	}
 
 	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard file_lock(file->mutex);
 
 	*nread = file->op_read(buf, nbytes);
 
@@ -420,6 +528,7 @@ error_code sys_fs_write(u32 fd, vm::cptr<void> buf, u64 nbytes, vm::ptr<u64> nwr
 	}
 
 	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard file_lock(file->mutex);
 
 	if (file->lock)
 	{
@@ -699,6 +808,7 @@ error_code sys_fs_fstat(u32 fd, vm::ptr<CellFsStat> sb)
 	}
 
 	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard file_lock(file->mutex);
 
 	const fs::stat_t& info = file->file.stat();
 
@@ -929,6 +1039,7 @@ error_code sys_fs_fcntl(u32 fd, u32 op, vm::ptr<void> _arg, u32 _size)
 		}
 
 		std::lock_guard lock(file->mp->mutex);
+		std::lock_guard file_lock(file->mutex);
 
 		if (op == 0x8000000b && file->lock)
 		{
@@ -1272,6 +1383,7 @@ error_code sys_fs_lseek(u32 fd, s64 offset, s32 whence, vm::ptr<u64> pos)
 	}
 
 	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard file_lock(file->mutex);
 
 	const u64 result = file->file.seek(offset, static_cast<fs::seek_mode>(whence));
 
@@ -1403,6 +1515,7 @@ error_code sys_fs_ftruncate(u32 fd, u64 size)
 	}
 
 	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard file_lock(file->mutex);
 
 	if (file->lock)
 	{
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Emu/Memory/vm.h"
+#include "Utilities/mutex.h"
 #include "Emu/Cell/ErrorCodes.h"
 
 // Open Flags
@@ -170,6 +171,9 @@ struct lv2_file final : lv2_fs_object
 	// Stream lock
 	atomic_t<u32> lock{0};
 
+	// File position lock (taken after the mount point lock, AIO takes only this one)
+	shared_mutex mutex;
+
 	lv2_file(const char* filename, fs::file&& file, s32 mode, s32 flags)
 		: lv2_fs_object(lv2_fs_object::get_mp(filename), filename)
 		, file(std::move(file))
@@ -186,10 +190,10 @@ struct lv2_file final : lv2_fs_object
 	{
 	}
 
-	// File reading with intermediate buffer
+	// File reading (directly into guest memory if possible)
 	u64 op_read(vm::ptr<void> buf, u64 size);
 
-	// File writing with intermediate buffer
+	// File writing (directly from guest memory if possible)
 	u64 op_write(vm::cptr<void> buf, u64 size);
 
 	// For MSELF support
@@ -24,6 +24,10 @@
 #include <poll.h>
 #endif
 
+#ifdef __linux__
+#include "sys_net_reactor.h"
+#endif
+
 
 
 LOG_CHANNEL(sys_net);
@@ -32,6 +36,11 @@ static std::vector<ppu_thread*> s_to_awake;
 
 static semaphore<> s_nw_mutex;
 
+#ifdef __linux__
+// Event loop of the network thread
+static net_reactor<lv2_socket> s_nw_reactor;
+#endif
+
 extern u64 get_system_time();
 
 // Error helper functions
@@ -110,15 +119,97 @@ static void network_clear_queue(ppu_thread& ppu)
 	});
 }
 
+// Enable polling for the socket events
+static void network_poll_add(lv2_socket& sock, bs_t<lv2_socket::poll> events)
+{
+#ifdef __linux__
+	if (!s_nw_reactor.add(sock, events))
+	{
+		sys_net.error("Failed to wake up network thread (%d)", errno);
+	}
+#else
+	sock.events += events;
+#endif
+}
+
+// Run the event processing workload of the socket (s_nw_mutex must be locked)
+static void network_process(lv2_socket& sock, bs_t<lv2_socket::poll> events)
+{
+	if (events)
+	{
+		std::lock_guard lock(sock.mutex);
+
+		for (auto it = sock.queue.begin(); events && it != sock.queue.end();)
+		{
+			if (it->second(events))
+			{
+				it = sock.queue.erase(it);
+				continue;
+			}
+
+			it++;
+		}
+
+		if (sock.queue.empty())
+		{
+			sock.events.store({});
+		}
+	}
+}
+
+// Awake threads signaled by poll/select (s_nw_mutex must be locked)
+static void network_awake_all()
+{
+	s_to_awake.erase(std::unique(s_to_awake.begin(), s_to_awake.end()), s_to_awake.end());
+
+	for (ppu_thread* ppu : s_to_awake)
+	{
+		network_clear_queue(*ppu);
+		lv2_obj::awake(*ppu);
+	}
+
+	s_to_awake.clear();
+}
+
 extern void network_thread_init()
 {
 	thread_ctrl::spawn("Network Thread", []()
 	{
+		s_to_awake.clear();
+
+#ifdef __linux__
+		if (!s_nw_reactor.open())
+		{
+			sys_net.fatal("Network thread: failed to initialize epoll (%d)", errno);
+			return;
+		}
+
+		do
+		{
+			// Wait for socket events or interest changes (timeout is only used to check for stop)
+			const int count = s_nw_reactor.wait(100);
+
+			std::lock_guard lock(s_nw_mutex);
+
+			if (!s_nw_reactor.process(count, network_process))
+			{
+				sys_net.error("Network thread: eventfd read failed (%d)", errno);
+			}
+
+			network_awake_all();
+
+			s_nw_reactor.update([](lv2_socket& sock, int error)
+			{
+				sys_net.error("epoll_ctl() failed (s=%d, errno=%d)", sock.socket, error);
+			});
+		}
+		while (!Emu.IsStopped());
+
+		s_nw_reactor.close();
+#else
 		std::vector<std::shared_ptr<lv2_socket>> socklist;
 		socklist.reserve(lv2_socket::id_count);
 
-		s_to_awake.clear();
-
 #ifdef _WIN32
 		HANDLE _eventh = CreateEventW(nullptr, false, false, nullptr);
 
@@ -180,37 +271,11 @@ extern void network_thread_init()
 					events += lv2_socket::poll::error;
 #endif
 
-				if (events)
-				{
-					std::lock_guard lock(socklist[i]->mutex);
-
-					for (auto it = socklist[i]->queue.begin(); events && it != socklist[i]->queue.end();)
-					{
-						if (it->second(events))
-						{
-							it = socklist[i]->queue.erase(it);
-							continue;
-						}
-
-						it++;
-					}
-
-					if (socklist[i]->queue.empty())
-					{
-						socklist[i]->events.store({});
-					}
-				}
+				network_process(sock, events);
 			}
 
-			s_to_awake.erase(std::unique(s_to_awake.begin(), s_to_awake.end()), s_to_awake.end());
+			network_awake_all();
 
-			for (ppu_thread* ppu : s_to_awake)
-			{
-				network_clear_queue(*ppu);
-				lv2_obj::awake(*ppu);
-			}
-
-			s_to_awake.clear();
 			socklist.clear();
 
 			// Obtain all active sockets
@@ -240,6 +305,7 @@ extern void network_thread_init()
 #ifdef _WIN32
 		CloseHandle(_eventh);
 		WSACleanup();
+#endif
 #endif
 	});
 }
@@ -299,7 +365,7 @@ s32 sys_net_bnet_accept(ppu_thread& ppu, s32 s, vm::ptr<sys_net_sockaddr> addr,
 		}
 
 		// Enable read event
-		sock.events += lv2_socket::poll::read;
+		network_poll_add(sock, lv2_socket::poll::read);
 		sock.queue.emplace_back(ppu.id, [&](bs_t<lv2_socket::poll> events) -> bool
 		{
 			if (events & lv2_socket::poll::read)
@@ -316,7 +382,7 @@ s32 sys_net_bnet_accept(ppu_thread& ppu, s32 s, vm::ptr<sys_net_sockaddr> addr,
 				}
 			}
 
-			sock.events += lv2_socket::poll::read;
+			network_poll_add(sock, lv2_socket::poll::read);
 			return false;
 		});
 
@@ -474,7 +540,7 @@ s32 sys_net_bnet_connect(ppu_thread& ppu, s32 s, vm::ptr<sys_net_sockaddr> addr,
 
 			if (result == SYS_NET_EINPROGRESS)
 			{
-				sock.events += lv2_socket::poll::write;
+				network_poll_add(sock, lv2_socket::poll::write);
 				sock.queue.emplace_back(u32{0}, [&sock](bs_t<lv2_socket::poll> events) -> bool
 				{
 					if (events & lv2_socket::poll::write)
@@ -497,7 +563,7 @@ s32 sys_net_bnet_connect(ppu_thread& ppu, s32 s, vm::ptr<sys_net_sockaddr> addr,
 						return true;
 					}
 
-					sock.events += lv2_socket::poll::write;
+					network_poll_add(sock, lv2_socket::poll::write);
 					return false;
 				});
 			}
@@ -505,7 +571,7 @@ s32 sys_net_bnet_connect(ppu_thread& ppu, s32 s, vm::ptr<sys_net_sockaddr> addr,
 			return false;
 		}
 
-		sock.events += lv2_socket::poll::write;
+		network_poll_add(sock, lv2_socket::poll::write);
 		sock.queue.emplace_back(ppu.id, [&](bs_t<lv2_socket::poll> events) -> bool
 		{
 			if (events & lv2_socket::poll::write)
@@ -529,7 +595,7 @@ s32 sys_net_bnet_connect(ppu_thread& ppu, s32 s, vm::ptr<sys_net_sockaddr> addr,
 				return true;
 			}
 
-			sock.events += lv2_socket::poll::write;
+			network_poll_add(sock, lv2_socket::poll::write);
 			return false;
 		});
 
@@ -917,7 +983,7 @@ s32 sys_net_bnet_recvfrom(ppu_thread& ppu, s32 s, vm::ptr<void> buf, u32 len, s3
 		}
 
 		// Enable read event
-		sock.events += lv2_socket::poll::read;
+		network_poll_add(sock, lv2_socket::poll::read);
 		sock.queue.emplace_back(ppu.id, [&](bs_t<lv2_socket::poll> events) -> bool
 		{
 			if (events & lv2_socket::poll::read)
@@ -934,7 +1000,7 @@ s32 sys_net_bnet_recvfrom(ppu_thread& ppu, s32 s, vm::ptr<void> buf, u32 len, s3
 				}
 			}
 
-			sock.events += lv2_socket::poll::read;
+			network_poll_add(sock, lv2_socket::poll::read);
 			return false;
 		});
 
@@ -1075,7 +1141,7 @@ s32 sys_net_bnet_sendto(ppu_thread& ppu, s32 s, vm::cptr<void> buf, u32 len, s32
 		}
 
 		// Enable write event
-		sock.events += lv2_socket::poll::write;
+		network_poll_add(sock, lv2_socket::poll::write);
 		sock.queue.emplace_back(ppu.id, [&](bs_t<lv2_socket::poll> events) -> bool
 		{
 			if (events & lv2_socket::poll::write)
@@ -1092,7 +1158,7 @@ s32 sys_net_bnet_sendto(ppu_thread& ppu, s32 s, vm::cptr<void> buf, u32 len, s32
 				}
 			}
 
-			sock.events += lv2_socket::poll::write;
+			network_poll_add(sock, lv2_socket::poll::write);
 			return false;
 		});
 
@@ -1534,7 +1600,7 @@ s32 sys_net_bnet_poll(ppu_thread& ppu, vm::ptr<sys_net_pollfd> fds, s32 nfds, s3
 				//if (fds[i].events & SYS_NET_POLLPRI) // Unimplemented
 				//	selected += lv2_socket::poll::error;
 
-				sock->events += selected;
+				network_poll_add(*sock, selected);
 				sock->queue.emplace_back(ppu.id, [sock, selected, fds, i, &signaled, &ppu](bs_t<lv2_socket::poll> events)
 				{
 					if (events & selected)
@@ -1551,7 +1617,7 @@ s32 sys_net_bnet_poll(ppu_thread& ppu, vm::ptr<sys_net_pollfd> fds, s32 nfds, s3
 						return true;
 					}
 
-					sock->events += selected;
+					network_poll_add(*sock, selected);
 					return false;
 				});
 			}
@@ -1729,7 +1795,7 @@ s32 sys_net_bnet_select(ppu_thread& ppu, s32 nfds, vm::ptr<sys_net_fd_set> readf
 			{
 				std::lock_guard lock(sock->mutex);
 
-				sock->events += selected;
+				network_poll_add(*sock, selected);
 				sock->queue.emplace_back(ppu.id, [sock, selected, i, &rread, &rwrite, &rexcept, &signaled, &ppu](bs_t<lv2_socket::poll> events)
 				{
 					if (events & selected)
@@ -1746,7 +1812,7 @@ s32 sys_net_bnet_select(ppu_thread& ppu, s32 nfds, vm::ptr<sys_net_fd_set> readf
 						return true;
 					}
 
-					sock->events += selected;
+					network_poll_add(*sock, selected);
 					return false;
 				});
 			}
@@ -299,7 +299,7 @@ struct sys_net_linger
 
 // Custom structure for sockets
 // We map host sockets to sequential IDs to return as descriptors because syscalls expect socket IDs to be under 1024.
-struct lv2_socket final
+struct lv2_socket final : std::enable_shared_from_this<lv2_socket>
 {
 #ifdef _WIN32
 	using socket_type = std::uintptr_t;
@@ -0,0 +1,277 @@
+#pragma once
+
+#include "Utilities/bit_set.h"
+#include "Utilities/mutex.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// epoll/eventfd event loop of the sys_net network thread (Linux only).
+// Socket type must provide `int socket` (native descriptor), `atomic_bs_t<poll> events` (selected events)
+// with poll::read, poll::write and poll::error, and derive from std::enable_shared_from_this.
+// Sockets are registered incrementally when their selected events change, and interest changes
+// wake up the waiting network thread through the eventfd.
+template <typename Socket>
+class net_reactor
+{
+public:
+	using poll = typename Socket::poll;
+
+private:
+	int m_epfd = -1;
+
+	// Wakeup eventfd (-1 if not running)
+	int m_evfd = -1;
+
+	// Sockets with changed poll interests (applied by the network thread)
+	std::vector<std::shared_ptr<Socket>> m_changed;
+
+	shared_mutex m_changed_mutex;
+
+	// Registered native sockets (socket, epoll events), network thread only
+	std::unordered_map<int, std::pair<std::weak_ptr<Socket>, u32>> m_registered;
+
+	// Sockets which need registration update, network thread only
+	std::vector<std::shared_ptr<Socket>> m_update;
+
+	::epoll_event m_events[64];
+
+public:
+	net_reactor() = default;
+
+	net_reactor(const net_reactor&) = delete;
+
+	net_reactor& operator=(const net_reactor&) = delete;
+
+	~net_reactor()
+	{
+		close();
+	}
+
+	// Create epoll and eventfd descriptors (network thread), returns false on error (see errno)
+	bool open()
+	{
+		const int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+		const int evfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+		::epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.fd = evfd;
+
+		if (epfd == -1 || evfd == -1 || ::epoll_ctl(epfd, EPOLL_CTL_ADD, evfd, &ev) != 0)
+		{
+			const int error = errno;
+
+			if (epfd != -1) ::close(epfd);
+			if (evfd != -1) ::close(evfd);
+
+			errno = error;
+			return false;
+		}
+
+		m_epfd = epfd;
+
+		std::lock_guard lock(m_changed_mutex);
+		m_changed.clear();
+		m_evfd = evfd;
+		return true;
+	}
+
+	// Stop accepting interest changes and release the descriptors (network thread)
+	void close()
+	{
+		int evfd;
+		{
+			std::lock_guard lock(m_changed_mutex);
+			m_changed.clear();
+			evfd = std::exchange(m_evfd, -1);
+		}
+
+		if (evfd != -1)
+		{
+			::close(evfd);
+		}
+
+		if (m_epfd != -1)
+		{
+			::close(std::exchange(m_epfd, -1));
+		}
+
+		m_registered.clear();
+		m_update.clear();
+	}
+
+	// Enable polling for the socket events (any thread), returns false if the network thread couldn't be woken up (see errno)
+	bool add(Socket& sock, bs_t<poll> events)
+	{
+		sock.events += events;
+
+		std::lock_guard lock(m_changed_mutex);
+
+		// Only the first change needs to wake up the network thread
+		const bool wake = m_changed.empty();
+
+		m_changed.emplace_back(sock.shared_from_this());
+
+		if (wake && m_evfd != -1)
+		{
+			const u64 value = 1;
+
+			if (::write(m_evfd, &value, sizeof(value)) != sizeof(value))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Wake up the network thread without interest changes (any thread)
+	void wake()
+	{
+		std::lock_guard lock(m_changed_mutex);
+
+		if (m_evfd != -1)
+		{
+			const u64 value = 1;
+			static_cast<void>(::write(m_evfd, &value, sizeof(value)));
+		}
+	}
+
+	// Wait for socket events or interest changes (network thread), returns the number of events or -1 on error
+	int wait(int timeout_ms)
+	{
+		return ::epoll_wait(m_epfd, m_events, static_cast<int>(std::size(m_events)), timeout_ms);
+	}
+
+	// Consume the events returned by wait() (network thread): func(Socket&, bs_t<poll>) is called
+	// for every socket with selected events reported. Returns false if the eventfd read failed (see errno).
+	template <typename F>
+	bool process(int count, F&& func)
+	{
+		bool result = true;
+
+		for (int i = 0; i < count; i++)
+		{
+			const int fd = m_events[i].data.fd;
+
+			if (fd == m_evfd)
+			{
+				u64 value;
+
+				if (::read(m_evfd, &value, sizeof(value)) != sizeof(value) && errno != EAGAIN)
+				{
+					result = false;
+				}
+
+				continue;
+			}
+
+			const auto found = m_registered.find(fd);
+
+			if (found == m_registered.end())
+			{
+				continue;
+			}
+
+			const auto sock = found->second.first.lock();
+
+			if (!sock || sock->socket != fd)
+			{
+				continue;
+			}
+
+			const u32 revents = m_events[i].events;
+
+			bs_t<poll> events{};
+
+			if (revents & (EPOLLIN | EPOLLHUP) && sock->events.test_and_reset(poll::read))
+				events += poll::read;
+			if (revents & EPOLLOUT && sock->events.test_and_reset(poll::write))
+				events += poll::write;
+			if (revents & EPOLLERR && sock->events.test_and_reset(poll::error))
+				events += poll::error;
+
+			func(*sock, events);
+
+			// Poll interests have been consumed (level-triggered epoll would report them again)
+			m_update.emplace_back(sock);
+		}
+
+		return result;
+	}
+
+	// Apply interest changes (network thread): on_error(Socket&, int errno) is called if a socket couldn't be registered
+	template <typename F>
+	void update(F&& on_error)
+	{
+		{
+			std::lock_guard lock(m_changed_mutex);
+			m_update.insert(m_update.end(), m_changed.begin(), m_changed.end());
+			m_changed.clear();
+		}
+
+		for (const auto& sock : m_update)
+		{
+			update(*sock, on_error);
+		}
+
+		m_update.clear();
+	}
+
+private:
+	template <typename F>
+	void update(Socket& sock, F& on_error)
+	{
+		const auto selected = sock.events.load();
+
+		const u32 mask =
+			(selected & poll::read ? EPOLLIN : 0) |
+			(selected & poll::write ? EPOLLOUT : 0);
+
+		auto& reg = m_registered[sock.socket];
+
+		// Closed sockets are removed from epoll automatically, the descriptor may be reused
+		const bool added = reg.second && reg.first.lock().get() == &sock;
+
+		if (added && reg.second == mask)
+		{
+			return;
+		}
+
+		::epoll_event ev{};
+		ev.events = mask;
+		ev.data.fd = sock.socket;
+
+		if (!mask)
+		{
+			if (added)
+			{
+				::epoll_ctl(m_epfd, EPOLL_CTL_DEL, sock.socket, &ev);
+			}
+
+			m_registered.erase(sock.socket);
+			return;
+		}
+
+		if (::epoll_ctl(m_epfd, added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, sock.socket, &ev) != 0)
+		{
+			if ((errno != ENOENT && errno != EEXIST) || ::epoll_ctl(m_epfd, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, sock.socket, &ev) != 0)
+			{
+				on_error(sock, errno);
+				m_registered.erase(sock.socket);
+				return;
+			}
+		}
+
+		reg = {sock.weak_from_this(), mask};
+	}
+};
@@ -3,6 +3,7 @@
 #include "Utilities/mutex.h"
 #include "Utilities/sema.h"
 #include "Utilities/cond.h"
+#include "Utilities/asm.h"
 
 #include "Emu/Memory/vm.h"
 #include "Emu/CPU/CPUThread.h"
@@ -11,6 +12,10 @@
 #include "Emu/IPC.h"
 
 #include <deque>
+#include <array>
+#include <vector>
+#include <set>
+#include <unordered_map>
 
 // attr_protocol (waiting scheduling policy)
 enum
@@ -55,6 +60,119 @@ enum
 	SYS_SYNC_ATTR_ADAPTIVE_MASK  = 0xf000,
 };
 
+// PPU scheduler queue: FIFO list per priority with a bitmap of non-empty lists
+class lv2_ppu_queue
+{
+	// Priorities above the limit share the last list
+	static constexpr u32 max_prio = 4096;
+
+	std::array<std::vector<class ppu_thread*>, max_prio> m_lists{};
+
+	std::array<u64, max_prio / 64> m_mask{};
+
+	std::size_t m_size = 0;
+
+	static u32 get_list(u32 prio)
+	{
+		return prio < max_prio ? prio : max_prio - 1;
+	}
+
+public:
+	// Add the thread to the end of its priority list (returns false if already queued)
+	bool push(ppu_thread* ppu, u32 prio)
+	{
+		auto& list = m_lists[get_list(prio)];
+
+		for (auto found : list)
+		{
+			if (found == ppu)
+			{
+				return false;
+			}
+		}
+
+		list.emplace_back(ppu);
+		m_mask[get_list(prio) / 64] |= 1ull << (get_list(prio) % 64);
+		m_size++;
+		return true;
+	}
+
+	// Remove the thread (prio is the priority it was queued with)
+	bool remove(ppu_thread* ppu, u32 prio)
+	{
+		auto& list = m_lists[get_list(prio)];
+
+		for (auto it = list.begin(); it != list.end(); it++)
+		{
+			if (*it == ppu)
+			{
+				list.erase(it);
+
+				if (list.empty())
+				{
+					m_mask[get_list(prio) / 64] &= ~(1ull << (get_list(prio) % 64));
+				}
+
+				m_size--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Check whether the thread is queued and is the last one in its priority list
+	bool is_last(ppu_thread* ppu, u32 prio) const
+	{
+		const auto& list = m_lists[get_list(prio)];
+
+		return !list.empty() && list.back() == ppu;
+	}
+
+	// Call func(ppu) for threads in scheduling order, skipping the first pos threads, until it returns false
+	template <typename F>
+	void for_each(std::size_t pos, F&& func) const
+	{
+		for (u32 i = 0; i < m_mask.size(); i++)
+		{
+			for (u64 bits = m_mask[i]; bits; bits &= bits - 1)
+			{
+				const auto& list = m_lists[i * 64 + utils::cnttz64(bits, true)];
+
+				if (pos >= list.size())
+				{
+					pos -= list.size();
+					continue;
+				}
+
+				for (std::size_t j = std::exchange(pos, 0); j < list.size(); j++)
+				{
+					if (!func(list[j]))
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	void clear()
+	{
+		for (auto& list : m_lists)
+		{
+			list.clear();
+		}
+
+		m_mask.fill(0);
+		m_size = 0;
+	}
+};
+
 // Base class for some kernel objects (shared set of 8192 objects).
 struct lv2_obj
 {
@@ -138,6 +256,9 @@ struct lv2_obj
 
 	static void cleanup();
 
+	// Notify threads whose timeouts expired, return the nearest registered timeout (-1 if none)
+	static u64 check_timeouts();
+
 	template <typename T, typename F>
 	static error_code create(u32 pshared, u64 ipc_key, s32 flags, F&& make)
 	{
@@ -218,13 +339,20 @@ private:
 	static semaphore<> g_mutex;
 
 	// Scheduler queue for active PPU threads
-	static std::deque<class ppu_thread*> g_ppu;
+	static lv2_ppu_queue g_ppu;
 
 	// Waiting for the response from
 	static std::deque<class cpu_thread*> g_pending;
 
-	// Scheduler queue for timeouts (wait until -> thread)
-	static std::deque<std::pair<u64, class cpu_thread*>> g_waiting;
+	// Scheduler queue for timeouts (wait until, thread), sorted
+	static std::set<std::pair<u64, class cpu_thread*>> g_waiting;
+
+	// Registered timeouts (thread -> wait until)
+	static std::unordered_map<class cpu_thread*, u64> g_timeouts;
+
+	static void remove_timeout(cpu_thread&);
+
+	static u64 notify_timeouts();
 
 	static void schedule_all();
 };
@@ -15,63 +15,149 @@ LOG_CHANNEL(sys_timer);
 
 extern u64 get_system_time();
 
-void lv2_timer_context::operator()()
+// Host timer resolution: sleep until this much time is left, then spin
+#ifdef __linux__
+constexpr u64 s_spin_threshold = 100;
+#else
+constexpr u64 s_spin_threshold = 500;
+#endif
+
+u64 lv2_timer_service_context::process_timers(u64 now)
 {
-	while (!Emu.IsStopped())
+	std::lock_guard lock(m_mutex);
+
+	while (!m_queue.empty() && m_queue.top().expire <= now)
 	{
-		const u32 _state = state;
+		const entry _entry = m_queue.top();
+		m_queue.pop();
+
+		const auto timer = _entry.timer.lock();
+
+		if (!timer)
+		{
+			continue;
+		}
 
-		if (_state == SYS_TIMER_STATE_RUN)
+		std::lock_guard timer_lock(timer->mutex);
+
+		if (timer->state != SYS_TIMER_STATE_RUN || timer->expire != _entry.expire)
 		{
-			const u64 _now = get_system_time();
-			const u64 next = expire;
+			// Stale entry (timer stopped or restarted)
+			continue;
+		}
 
-			if (_now >= next)
+		if (const auto queue = timer->port.lock())
+		{
+			queue->send(timer->source, timer->data1, timer->data2, _entry.expire);
+
+			if (const u64 period = timer->period)
 			{
-				std::lock_guard lock(mutex);
-
-				if (const auto queue = port.lock())
-				{
-					queue->send(source, data1, data2, next);
-
-					if (period)
-					{
-						// Set next expiration time and check again (HACK)
-						expire += period;
-						continue;
-					}
-				}
-
-				// Stop: oneshot or the event port was disconnected (TODO: is it correct?)
-				state = SYS_TIMER_STATE_STOP;
+				// Skip missed periods instead of sending a burst of events
+				const u64 missed = (now - _entry.expire) / period;
+
+				m_skipped += missed;
+				timer->expire = _entry.expire + period * (missed + 1);
+				m_queue.push({timer->expire, timer});
 				continue;
 			}
+		}
+
+		// Stop: oneshot or the event port was disconnected (TODO: is it correct?)
+		timer->state = SYS_TIMER_STATE_STOP;
+	}
 
-			// TODO: use single global dedicated thread for busy waiting, no timer threads
-			thread_ctrl::wait_for(next - _now);
+	return m_queue.empty() ? UINT64_MAX : m_queue.top().expire;
+}
+
+void lv2_timer_service_context::operator()()
+{
+	while (thread_ctrl::state() != thread_state::aborting && !Emu.IsStopped())
+	{
+		// Any deadline added during the scan must wake the service
+		m_target = UINT64_MAX;
+
+		const u64 next = std::min(process_timers(get_system_time()), lv2_obj::check_timeouts());
+
+		m_target = next;
+
+		if (next == UINT64_MAX)
+		{
+			thread_ctrl::wait();
+			continue;
 		}
-		else if (_state == SYS_TIMER_STATE_STOP)
+
+		u64 now = get_system_time();
+
+		if (next > now + s_spin_threshold)
 		{
-			thread_ctrl::wait_for(10000);
+			if (thread_ctrl::wait_for(next - now - s_spin_threshold))
+			{
+				// Woken up by an earlier deadline
+				continue;
+			}
+
+			now = get_system_time();
 		}
-		else
+
+		bool notified = false;
+
+		while (now < next)
 		{
-			break;
+			if (thread_ctrl::wait_for(0))
+			{
+				notified = true;
+				break;
+			}
+
+			std::this_thread::yield();
+			now = get_system_time();
+		}
+
+		if (!notified)
+		{
+			const u64 jitter = now - next;
+
+			m_wakeups++;
+			m_jitter_sum += jitter;
+			m_jitter_max = std::max(m_jitter_max, jitter);
+
+			if (jitter > s_spin_threshold)
+			{
+				m_late++;
+			}
 		}
 	}
+
+	if (m_wakeups)
+	{
+		sys_timer.notice("Timer service: %u wake-ups, jitter avg=%uus max=%uus, late (>%uus): %u, skipped periods: %u",
+			m_wakeups, m_jitter_sum / m_wakeups, m_jitter_max, s_spin_threshold, m_late, m_skipped);
+	}
+}
+
+void lv2_timer_service_context::add(const std::shared_ptr<lv2_timer>& timer, u64 expire)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_queue.push({expire, timer});
+	}
+
+	wake(expire);
 }
 
-void lv2_timer_context::on_abort()
+void lv2_timer_service_context::wake(u64 deadline)
 {
-	// Signal thread using invalid state
-	state = -1;
+	if (deadline < m_target)
+	{
+		thread_ctrl::notify(*static_cast<lv2_timer_service*>(this));
+	}
 }
 
 error_code sys_timer_create(vm::ptr<u32> timer_id)
 {
 	sys_timer.warning("sys_timer_create(timer_id=*0x%x)", timer_id);
 
-	if (const u32 id = idm::make<lv2_obj, lv2_timer>("Timer Thread"))
+	if (const u32 id = idm::make<lv2_obj, lv2_timer>())
 	{
 		*timer_id = id;
 		return CELL_OK;
@@ -148,9 +234,11 @@ error_code _sys_timer_start(u32 timer_id, u64 base_time, u64 period)
 		return CELL_EINVAL;
 	}
 
-	const auto timer = idm::check<lv2_obj, lv2_timer>(timer_id, [&](lv2_timer& timer) -> CellError
+	u64 expire = 0;
+
+	const auto timer = idm::get<lv2_obj, lv2_timer>(timer_id, [&](lv2_timer& timer) -> CellError
 	{
-		std::unique_lock lock(timer.mutex);
+		std::lock_guard lock(timer.mutex);
 
 		if (timer.state != SYS_TIMER_STATE_STOP)
 		{
@@ -163,12 +251,11 @@ error_code _sys_timer_start(u32 timer_id, u64 base_time, u64 period)
 		}
 
 		// sys_timer_start_periodic() will use current time (TODO: is it correct?)
-		timer.expire = base_time ? base_time : start_time + period;
+		expire = base_time ? base_time : start_time + period;
+
+		timer.expire = expire;
 		timer.period = period;
 		timer.state  = SYS_TIMER_STATE_RUN;
-
-		lock.unlock();
-		thread_ctrl::notify(timer);
 		return {};
 	});
 
@@ -182,6 +269,11 @@ error_code _sys_timer_start(u32 timer_id, u64 base_time, u64 period)
 		return timer.ret;
 	}
 
+	if (const auto service = fxm::get<lv2_timer_service>())
+	{
+		service->add(timer.ptr, expire);
+	}
+
 	return CELL_OK;
 }
 
@@ -293,40 +385,24 @@ error_code sys_timer_usleep(ppu_thread& ppu, u64 sleep_time)
 
 	if (sleep_time)
 	{
-#ifdef __linux__
-		constexpr u32 host_min_quantum = 100;
-#else
-		// Host scheduler quantum for windows (worst case)
-		// NOTE: On ps3 this function has very high accuracy
-		constexpr u32 host_min_quantum = 500;
-#endif
-
-		u64 passed = 0;
-		u64 remaining;
-
+		// The timer service notifies the thread at the deadline
 		lv2_obj::sleep(ppu, sleep_time);
 
-		while (sleep_time >= passed)
+		while (true)
 		{
 			if (ppu.is_stopped())
 			{
 				return 0;
 			}
 
-			remaining = sleep_time - passed;
+			const u64 passed = get_system_time() - ppu.start_time;
 
-			if (remaining > host_min_quantum)
-			{
-				// Wait on multiple of min quantum for large durations
-				thread_ctrl::wait_for(remaining - (remaining % host_min_quantum));
-			}
-			else
+			if (passed >= sleep_time)
 			{
-				// Try yielding. May cause long wake latency but helps weaker CPUs a lot by alleviating resource pressure
-				std::this_thread::yield();
+				break;
 			}
 
-			passed = (get_system_time() - ppu.start_time);
+			thread_ctrl::wait_for(sleep_time - passed);
 		}
 	}
 	else
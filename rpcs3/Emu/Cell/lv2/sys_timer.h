@@ -2,6 +2,8 @@
 
 #include "Utilities/Thread.h"
 
+#include <queue>
+
 // Timer State
 enum : u32
 {
@@ -17,13 +19,10 @@ struct sys_timer_information_t
 	be_t<u32> pad;
 };
 
-struct lv2_timer_context : lv2_obj
+struct lv2_timer : lv2_obj
 {
 	static const u32 id_base = 0x11000000;
 
-	void operator()();
-	void on_abort();
-
 	semaphore<> mutex;
 	atomic_t<u32> state{SYS_TIMER_STATE_STOP};
 
@@ -36,7 +35,52 @@ struct lv2_timer_context : lv2_obj
 	atomic_t<u64> period{0}; // Period (oneshot if 0)
 };
 
-using lv2_timer = named_thread<lv2_timer_context>;
+// Single thread serving all sys_timer objects and lv2 wait timeouts
+class lv2_timer_service_context
+{
+	// Scheduled timer expiration
+	struct entry
+	{
+		u64 expire;
+		std::weak_ptr<lv2_timer> timer;
+
+		bool operator<(const entry& rhs) const
+		{
+			// Reversed for min-heap
+			return expire > rhs.expire;
+		}
+	};
+
+	shared_mutex m_mutex;
+
+	// Pending expirations (may contain stale entries of stopped or restarted timers)
+	std::priority_queue<entry> m_queue;
+
+	// Deadline the service is currently waiting for (-1 while scanning)
+	atomic_t<u64> m_target{UINT64_MAX};
+
+	// Wake-up jitter statistics (usec)
+	u64 m_wakeups = 0;
+	u64 m_jitter_sum = 0;
+	u64 m_jitter_max = 0;
+	u64 m_late = 0;
+	u64 m_skipped = 0;
+
+	// Send events for expired timers, return the nearest pending expiration
+	u64 process_timers(u64 now);
+
+public:
+	void operator()();
+
+	// Schedule timer expiration
+	void add(const std::shared_ptr<lv2_timer>& timer, u64 expire);
+
+	// Make sure the service wakes up at the deadline
+	void wake(u64 deadline);
+};
+
+// Started with the emulation (fxm)
+using lv2_timer_service = named_thread<lv2_timer_service_context>;
 
 class ppu_thread;
 
@@ -7,38 +7,42 @@ shared_mutex id_manager::g_mutex;
 thread_local DECLARE(idm::g_id);
 DECLARE(idm::g_map);
 DECLARE(fxm::g_vec);
+DECLARE(fxm::g_locks);
 
 id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32 base, u32 step, u32 count)
 {
 	// Base type id is stored in value
-	auto& vec = g_map[info.value()];
+	auto& map = g_map[info.value()];
 
-	// Preallocate memory
-	vec.reserve(count);
+	// Preallocate memory (slots are never relocated)
+	const auto data = map.reserve(count);
 
-	if (vec.size() < count)
+	const u32 size = map.size();
+
+	if (size < count)
 	{
-		// Try to emplace back
-		const u32 _next = base + step * ::size32(vec);
+		// Try to use next unused slot
+		const u32 _next = base + step * size;
 
 		if (_next >= base && _next < base + step * count)
 		{
 			g_id = _next;
-			vec.emplace_back(id_manager::id_key(_next, info.type()), nullptr);
-			return &vec.back();
+			atomic_storage<id_manager::id_key>::store(data[size].first, id_manager::id_key(_next, info.type()));
+			map.grow(size + 1);
+			return &data[size];
 		}
 	}
 
 	// Check all IDs starting from "next id" (TODO)
 	for (u32 i = 0, next = base; i < count; i++, next += step)
 	{
-		const auto ptr = &vec[i];
+		const auto ptr = &data[i];
 
 		// Look for free ID
 		if (!ptr->second)
 		{
 			g_id = next;
-			ptr->first = id_manager::id_key(next, info.type());
+			atomic_storage<id_manager::id_key>::store(ptr->first, id_manager::id_key(next, info.type()));
 			return ptr;
 		}
 	}
@@ -50,22 +54,16 @@ id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32
 void idm::init()
 {
 	// Allocate
-	g_map.resize(id_manager::typeinfo::get_count());
+	g_map = std::make_unique<id_manager::id_map[]>(id_manager::typeinfo::get_count());
 	idm::clear();
 }
 
 void idm::clear()
 {
 	// Call recorded finalization functions for all IDs
-	for (auto& map : g_map)
+	for (u32 i = 0; i < id_manager::typeinfo::get_count(); i++)
 	{
-		for (auto& pair : map)
-		{
-			pair.second.reset();
-			pair.first = {};
-		}
-
-		map.clear();
+		g_map[i].clear();
 	}
 }
 
@@ -73,14 +71,17 @@ void fxm::init()
 {
 	// Allocate
 	g_vec.resize(id_manager::typeinfo::get_count());
+	g_locks = std::make_unique<shared_mutex[]>(g_vec.size());
 	fxm::clear();
 }
 
 void fxm::clear()
 {
 	// Call recorded finalization functions for all IDs
-	for (auto& val : g_vec)
+	for (u32 i = 0; i < g_vec.size(); i++)
 	{
-		val.reset();
+		std::shared_ptr<void> old;
+		std::lock_guard lock(g_locks[i]);
+		old.swap(g_vec[i]);
 	}
 }
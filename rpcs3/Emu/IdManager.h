@@ -83,8 +83,8 @@ namespace id_manager
 	template <typename T>
 	const u32 typeinfo::registered<T>::index = typeinfo::add_type(1);
 
-	// ID value with additional type stored
-	class id_key
+	// ID value with additional type stored (can be read atomically)
+	class alignas(8) id_key
 	{
 		u32 m_value;           // ID value
 		u32 m_type;            // True object type
@@ -114,7 +114,116 @@ namespace id_manager
 		}
 	};
 
-	using id_map = std::vector<std::pair<id_key, std::shared_ptr<void>>>;
+	// Fixed-capacity ID table for one base type (slots are never relocated, so they can be read without g_mutex)
+	// Readers not holding g_mutex only take the lock of the slot, writers hold g_mutex and the slot lock
+	class id_map
+	{
+	public:
+		using value_type = std::pair<id_key, std::shared_ptr<void>>;
+		using pointer = value_type*;
+
+	private:
+		// Slots (allocated once, id_count elements)
+		atomic_t<pointer> m_data{nullptr};
+
+		// Slot locks (allocated with slots)
+		atomic_t<shared_mutex*> m_locks{nullptr};
+
+		// Number of allocated slots
+		u32 m_capacity = 0;
+
+		// Number of slots in use (max index + 1)
+		atomic_t<u32> m_size{0};
+
+	public:
+		id_map() = default;
+
+		id_map(const id_map&) = delete;
+
+		id_map& operator=(const id_map&) = delete;
+
+		~id_map()
+		{
+			delete[] m_data.load();
+			delete[] m_locks.load();
+		}
+
+		// Allocate slots if necessary (must be called under writer lock)
+		pointer reserve(u32 count)
+		{
+			if (!m_data)
+			{
+				m_locks = new shared_mutex[count]{};
+				m_data = new value_type[count]{};
+				m_capacity = count;
+			}
+
+			// All types sharing the base type must have the same or smaller id_count
+			verify("id_map::reserve" HERE), count <= m_capacity;
+
+			return m_data;
+		}
+
+		// Make slot visible for readers not holding g_mutex (must be called under writer lock)
+		void grow(u32 size)
+		{
+			if (size > m_size)
+			{
+				m_size = size;
+			}
+		}
+
+		// Remove all objects (must be called under writer lock)
+		void clear()
+		{
+			const u32 size = m_size.exchange(0);
+
+			for (u32 i = 0; i < size; i++)
+			{
+				exchange(m_data + i, nullptr);
+				atomic_storage<id_key>::store(m_data[i].first, {});
+			}
+		}
+
+		// Get the object of the slot with specified type (type 0 matches any), doesn't need g_mutex
+		std::shared_ptr<void> load(u32 index, u32 type) const
+		{
+			const auto& data = m_data[index];
+
+			reader_lock lock(m_locks[index]);
+
+			// Type is only changed while the slot is empty
+			if (type && atomic_storage<id_key>::load(data.first).type() != type)
+			{
+				return nullptr;
+			}
+
+			return data.second;
+		}
+
+		// Replace the object of the slot, returns the old one (must be called under writer lock)
+		std::shared_ptr<void> exchange(pointer slot, std::shared_ptr<void> ptr)
+		{
+			std::lock_guard lock(m_locks[slot - m_data]);
+			slot->second.swap(ptr);
+			return ptr;
+		}
+
+		pointer begin() const
+		{
+			return m_data;
+		}
+
+		pointer end() const
+		{
+			return m_data + m_size;
+		}
+
+		u32 size() const
+		{
+			return m_size;
+		}
+	};
 }
 
 // Object manager for emulated process. Multiple objects of specified arbitrary type are given unique IDs.
@@ -124,7 +233,7 @@ class idm
 	static thread_local u32 g_id;
 
 	// Type Index -> ID -> Object. Use global since only one process is supported atm.
-	static std::vector<id_manager::id_map> g_map;
+	static std::unique_ptr<id_manager::id_map[]> g_map;
 
 	template <typename T>
 	static inline u32 get_type()
@@ -217,14 +326,14 @@ class idm
 
 		const u32 index = get_index<Type>(id);
 
-		auto& vec = g_map[get_type<T>()];
+		auto& map = g_map[get_type<T>()];
 
-		if (index >= vec.size() || index >= id_manager::id_traits<Type>::count)
+		if (index >= map.size() || index >= id_manager::id_traits<Type>::count)
 		{
 			return nullptr;
 		}
 
-		auto& data = vec[index];
+		auto& data = map.begin()[index];
 
 		if (data.second)
 		{
@@ -237,9 +346,27 @@ class idm
 		return nullptr;
 	}
 
+	// Find ID and get the object without g_mutex (takes the slot lock)
+	template <typename T, typename Type>
+	static std::shared_ptr<void> load_id(u32 id)
+	{
+		static_assert(id_manager::id_verify<T, Type>::value, "Invalid ID type combination");
+
+		const u32 index = get_index<Type>(id);
+
+		const auto& map = g_map[get_type<T>()];
+
+		if (index >= map.size() || index >= id_manager::id_traits<Type>::count)
+		{
+			return nullptr;
+		}
+
+		return map.load(index, std::is_same<T, Type>::value ? 0 : get_type<Type>());
+	}
+
 	// Allocate new ID and assign the object from the provider()
 	template <typename T, typename Type, typename F>
-	static id_manager::id_map::pointer create_id(F&& provider)
+	static id_manager::id_map::value_type create_id(F&& provider)
 	{
 		static_assert(id_manager::id_verify<T, Type>::value, "Invalid ID type combination");
 
@@ -255,15 +382,16 @@ class idm
 		if (auto* place = allocate_id(info, traits::base, traits::step, traits::count))
 		{
 			// Get object, store it
-			place->second = provider();
+			std::shared_ptr<void> ptr = provider();
 
-			if (place->second)
+			if (ptr)
 			{
-				return place;
+				g_map[get_type<T>()].exchange(place, ptr);
+				return {place->first, std::move(ptr)};
 			}
 		}
 
-		return nullptr;
+		return {};
 	}
 
 public:
@@ -283,9 +411,9 @@ public:
 	template <typename T, typename Make = T, typename... Args>
 	static inline std::enable_if_t<std::is_constructible<Make, Args...>::value, std::shared_ptr<Make>> make_ptr(Args&&... args)
 	{
-		if (auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }))
+		if (auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }); pair.second)
 		{
-			return {pair->second, static_cast<Make*>(pair->second.get())};
+			return {pair.second, static_cast<Make*>(pair.second.get())};
 		}
 
 		return nullptr;
@@ -295,9 +423,9 @@ public:
 	template <typename T, typename Make = T, typename... Args>
 	static inline std::enable_if_t<std::is_constructible<Make, Args...>::value, u32> make(Args&&... args)
 	{
-		if (auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }))
+		if (auto pair = create_id<T, Make>([&] { return std::make_shared<Make>(std::forward<Args>(args)...); }); pair.second)
 		{
-			return pair->first;
+			return pair.first;
 		}
 
 		return id_manager::id_traits<Make>::invalid;
@@ -307,9 +435,9 @@ public:
 	template <typename T, typename Made = T>
 	static inline u32 import_existing(const std::shared_ptr<T>& ptr)
 	{
-		if (auto pair = create_id<T, Made>([&] { return ptr; }))
+		if (auto pair = create_id<T, Made>([&] { return ptr; }); pair.second)
 		{
-			return pair->first;
+			return pair.first;
 		}
 
 		return id_manager::id_traits<Made>::invalid;
@@ -319,9 +447,9 @@ public:
 	template <typename T, typename Made = T, typename F, typename = std::invoke_result_t<F>>
 	static inline u32 import(F&& provider)
 	{
-		if (auto pair = create_id<T, Made>(std::forward<F>(provider)))
+		if (auto pair = create_id<T, Made>(std::forward<F>(provider)); pair.second)
 		{
-			return pair->first;
+			return pair.first;
 		}
 
 		return id_manager::id_traits<Made>::invalid;
@@ -346,13 +474,11 @@ public:
 		return nullptr;
 	}
 
-	// Check the ID
+	// Check the ID (doesn't take g_mutex)
 	template <typename T, typename Get = T>
 	static inline Get* check(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
-
-		return check_unlocked<T, Get>(id);
+		return static_cast<Get*>(load_id<T, Get>(id).get());
 	}
 
 	// Check the ID, access object under shared lock
@@ -398,20 +524,18 @@ public:
 		return {found->second, static_cast<Get*>(found->second.get())};
 	}
 
-	// Get the object
+	// Get the object (doesn't take g_mutex)
 	template <typename T, typename Get = T>
 	static inline std::shared_ptr<Get> get(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
-
-		const auto found = find_id<T, Get>(id);
+		std::shared_ptr<void> ptr = load_id<T, Get>(id);
 
-		if (UNLIKELY(found == nullptr))
+		if (UNLIKELY(!ptr))
 		{
 			return nullptr;
 		}
 
-		return {found->second, static_cast<Get*>(found->second.get())};
+		return {ptr, static_cast<Get*>(ptr.get())};
 	}
 
 	// Get the object, access object under reader lock
@@ -503,7 +627,7 @@ public:
 
 			if (const auto found = find_id<T, Get>(id))
 			{
-				ptr = std::move(found->second);
+				ptr = g_map[get_type<T>()].exchange(found, nullptr);
 			}
 			else
 			{
@@ -524,7 +648,7 @@ public:
 
 			if (const auto found = find_id<T, Get>(id))
 			{
-				ptr = std::move(found->second);
+				ptr = g_map[get_type<T>()].exchange(found, nullptr);
 			}
 			else
 			{
@@ -548,7 +672,7 @@ public:
 			if constexpr (std::is_void_v<FRT>)
 			{
 				func(*_ptr);
-				std::shared_ptr<void> ptr = std::move(found->second);
+				std::shared_ptr<void> ptr = g_map[get_type<T>()].exchange(found, nullptr);
 				return {ptr, static_cast<Get*>(ptr.get())};
 			}
 			else
@@ -561,7 +685,7 @@ public:
 					return {{found->second, _ptr}, std::move(ret)};
 				}
 
-				std::shared_ptr<void> ptr = std::move(found->second);
+				std::shared_ptr<void> ptr = g_map[get_type<T>()].exchange(found, nullptr);
 				return {{ptr, static_cast<Get*>(ptr.get())}, std::move(ret)};
 			}
 		}
@@ -576,12 +700,36 @@ class fxm
 	// Type Index -> Object. Use global since only one process is supported atm.
 	static std::vector<std::shared_ptr<void>> g_vec;
 
+	// Type Index -> Object lock (readers not holding g_mutex only take this lock, writers hold both)
+	static std::unique_ptr<shared_mutex[]> g_locks;
+
 	template <typename T>
 	static inline u32 get_type()
 	{
 		return id_manager::typeinfo::get_index<T>();
 	}
 
+	// Get the object without g_mutex
+	template <typename T>
+	static inline std::shared_ptr<void> load()
+	{
+		const u32 type = get_type<T>();
+
+		reader_lock lock(g_locks[type]);
+		return g_vec[type];
+	}
+
+	// Replace the object, returns the old one (must be called under g_mutex)
+	template <typename T>
+	static inline std::shared_ptr<void> exchange(std::shared_ptr<void> ptr)
+	{
+		const u32 type = get_type<T>();
+
+		std::lock_guard lock(g_locks[type]);
+		g_vec[type].swap(ptr);
+		return ptr;
+	}
+
 public:
 	// Initialize object manager
 	static void init();
@@ -602,7 +750,7 @@ public:
 			if (!cur)
 			{
 				ptr = std::make_shared<Make>(std::forward<Args>(args)...);
-				cur = ptr;
+				exchange<T>(ptr);
 			}
 			else
 			{
@@ -622,11 +770,8 @@ public:
 		{
 			std::lock_guard lock(id_manager::g_mutex);
 
-			auto& cur = g_vec[get_type<T>()];
-
 			ptr = std::make_shared<Make>(std::forward<Args>(args)...);
-			old = std::move(cur);
-			cur = ptr;
+			old = exchange<T>(ptr);
 		}
 
 		return ptr;
@@ -648,7 +793,7 @@ public:
 
 				if (ptr)
 				{
-					cur = ptr;
+					exchange<T>(ptr);
 				}
 			}
 
@@ -670,14 +815,11 @@ public:
 		{
 			std::lock_guard lock(id_manager::g_mutex);
 
-			auto& cur = g_vec[get_type<T>()];
-
 			ptr = provider();
 
 			if (ptr)
 			{
-				old = std::move(cur);
-				cur = ptr;
+				old = exchange<T>(ptr);
 			}
 			else
 			{
@@ -705,7 +847,7 @@ public:
 			else
 			{
 				ptr = std::make_shared<Make>(std::forward<Args>(args)...);
-				old = ptr;
+				exchange<T>(ptr);
 			}
 		}
 
@@ -719,22 +861,18 @@ public:
 		return static_cast<T*>(g_vec[get_type<T>()].get());
 	}
 
-	// Check whether the object exists
+	// Check whether the object exists (doesn't take g_mutex)
 	template <typename T>
 	static inline T* check()
 	{
-		reader_lock lock(id_manager::g_mutex);
-
-		return check_unlocked<T>();
+		return static_cast<T*>(load<T>().get());
 	}
 
-	// Get the object (returns nullptr if it doesn't exist)
+	// Get the object (returns nullptr if it doesn't exist, doesn't take g_mutex)
 	template <typename T>
 	static inline std::shared_ptr<T> get()
 	{
-		reader_lock lock(id_manager::g_mutex);
-
-		auto& ptr = g_vec[get_type<T>()];
+		std::shared_ptr<void> ptr = load<T>();
 
 		return {ptr, static_cast<T*>(ptr.get())};
 	}
@@ -746,7 +884,7 @@ public:
 		std::shared_ptr<void> ptr;
 		{
 			std::lock_guard lock(id_manager::g_mutex);
-			ptr = std::move(g_vec[get_type<T>()]);
+			ptr = exchange<T>(nullptr);
 		}
 
 		return ptr.operator bool();
@@ -759,7 +897,7 @@ public:
 		std::shared_ptr<void> ptr;
 		{
 			std::lock_guard lock(id_manager::g_mutex);
-			ptr = std::move(g_vec[get_type<T>()]);
+			ptr = exchange<T>(nullptr);
 		}
 
 		return {ptr, static_cast<T*>(ptr.get())};
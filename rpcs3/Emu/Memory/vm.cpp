@@ -519,6 +519,8 @@ namespace vm
 
 	bool block_t::try_alloc(u32 addr, u8 flags, u32 size, std::shared_ptr<utils::shm>&& shm)
 	{
+		vm::writer_lock lock(0);
+
 		// Check if memory area is already mapped
 		for (u32 i = addr / 4096; i <= (addr + size - 1) / 4096; i++)
 		{
@@ -528,6 +530,11 @@ namespace vm
 			}
 		}
 
+		if (!take_free(addr, size))
+		{
+			return false;
+		}
+
 		const u32 page_addr = addr + (this->flags & 0x10 ? 0x1000 : 0);
 		const u32 page_size = size - (this->flags & 0x10 ? 0x2000 : 0);
 
@@ -543,10 +550,72 @@ namespace vm
 
 		// Add entry
 		m_map[addr] = std::make_pair(size, std::move(shm));
+		m_used += size - (this->flags & 0x10 ? 0x2000 : 0);
+
+		return true;
+	}
+
+	bool block_t::take_free(u32 addr, u32 size)
+	{
+		auto found = m_free.upper_bound(addr);
+
+		if (found == m_free.begin())
+		{
+			return false;
+		}
+
+		found--;
+
+		// End of the range may be 0x100000000
+		const u32 start = found->first;
+		const u64 end = u64{start} + found->second;
+
+		if (addr + u64{size} > end)
+		{
+			return false;
+		}
+
+		m_free.erase(found);
+
+		// Return the remainders
+		if (addr > start)
+		{
+			m_free.emplace(start, addr - start);
+		}
+
+		if (addr + u64{size} < end)
+		{
+			m_free.emplace(addr + size, static_cast<u32>(end - addr - size));
+		}
 
 		return true;
 	}
 
+	void block_t::add_free(u32 addr, u32 size)
+	{
+		// Merge with the next range
+		const auto next = addr + u64{size} < 0x100000000 ? m_free.find(addr + size) : m_free.end();
+
+		if (next != m_free.end())
+		{
+			size += next->second;
+			m_free.erase(next);
+		}
+
+		// Merge with the previous range
+		const auto prev = m_free.lower_bound(addr);
+
+		if (prev != m_free.begin() && std::prev(prev)->first + std::prev(prev)->second == addr)
+		{
+			const auto found = std::prev(prev);
+			addr = found->first;
+			size += found->second;
+			m_free.erase(found);
+		}
+
+		m_free.emplace(addr, size);
+	}
+
 	block_t::block_t(u32 addr, u32 size, u64 flags)
 		: addr(addr)
 		, size(size)
@@ -586,6 +655,9 @@ namespace vm
 			verify(HERE), m_common->map_critical(vm::base(addr), utils::protection::no) == vm::base(addr);
 			verify(HERE), m_common->map_critical(vm::get_super_ptr(addr), utils::protection::no) == vm::get_super_ptr(addr);
 		}
+
+		// Whole block is free
+		add_free(addr, size);
 	}
 
 	block_t::~block_t()
@@ -613,8 +685,6 @@ namespace vm
 
 	u32 block_t::alloc(const u32 orig_size, u32 align, const std::shared_ptr<utils::shm>* src)
 	{
-		vm::writer_lock lock(0);
-
 		// Determine minimal alignment
 		const u32 min_page_size = flags & 0x100 ? 0x1000 : 0x10000;
 
@@ -654,12 +724,19 @@ namespace vm
 		else
 			shm = std::make_shared<utils::shm>(size);
 
-		// Search for an appropriate place (unoptimized)
-		for (u32 addr = ::align(this->addr, align); addr < this->addr + this->size - 1; addr += align)
+		std::lock_guard lock(m_mutex);
+
+		// Search for an appropriate place (lowest address first)
+		for (const auto& range : m_free)
 		{
-			if (try_alloc(addr, pflags, size, std::move(shm)))
+			const u64 end = u64{range.first} + range.second;
+
+			for (u64 addr = ::align<u64>(range.first, align); addr + size <= end; addr += align)
 			{
-				return addr + (flags & 0x10 ? 0x1000 : 0);
+				if (try_alloc(static_cast<u32>(addr), pflags, size, std::move(shm)))
+				{
+					return static_cast<u32>(addr) + (flags & 0x10 ? 0x1000 : 0);
+				}
 			}
 		}
 
@@ -668,8 +745,6 @@ namespace vm
 
 	u32 block_t::falloc(u32 addr, const u32 orig_size, const std::shared_ptr<utils::shm>* src)
 	{
-		vm::writer_lock lock(0);
-
 		// Determine minimal alignment
 		const u32 min_page_size = flags & 0x100 ? 0x1000 : 0x10000;
 
@@ -703,6 +778,8 @@ namespace vm
 		else
 			shm = std::make_shared<utils::shm>(size);
 
+		std::lock_guard lock(m_mutex);
+
 		if (!try_alloc(addr, pflags, size, std::move(shm)))
 		{
 			return 0;
@@ -714,7 +791,7 @@ namespace vm
 	u32 block_t::dealloc(u32 addr, const std::shared_ptr<utils::shm>* src)
 	{
 		{
-			vm::writer_lock lock(0);
+			std::lock_guard lock(m_mutex);
 
 			const auto found = m_map.find(addr - (flags & 0x10 ? 0x1000 : 0));
 
@@ -731,17 +808,23 @@ namespace vm
 			// Get allocation size
 			const auto size = found->second.first - (flags & 0x10 ? 0x2000 : 0);
 
-			if (flags & 0x10)
 			{
-				// Clear guard pages
-				verify(HERE), g_pages[addr / 4096 - 1].flags.exchange(0) == page_allocated;
-				verify(HERE), g_pages[addr / 4096 + size / 4096].flags.exchange(0) == page_allocated;
-			}
+				vm::writer_lock lock(0);
 
-			// Unmap "real" memory pages
-			verify(HERE), size == _page_unmap(addr, size, found->second.second.get());
+				if (flags & 0x10)
+				{
+					// Clear guard pages
+					verify(HERE), g_pages[addr / 4096 - 1].flags.exchange(0) == page_allocated;
+					verify(HERE), g_pages[addr / 4096 + size / 4096].flags.exchange(0) == page_allocated;
+				}
+
+				// Unmap "real" memory pages
+				verify(HERE), size == _page_unmap(addr, size, found->second.second.get());
+			}
 
 			// Remove entry
+			add_free(found->first, found->second.first);
+			m_used -= size;
 			m_map.erase(found);
 
 			return size;
@@ -755,7 +838,7 @@ namespace vm
 			return {addr, nullptr};
 		}
 
-		vm::reader_lock lock;
+		::reader_lock lock(m_mutex);
 
 		const auto upper = m_map.upper_bound(addr);
 
@@ -789,21 +872,12 @@ namespace vm
 
 	u32 block_t::imp_used(const vm::writer_lock&)
 	{
-		u32 result = 0;
-
-		for (auto& entry : m_map)
-		{
-			result += entry.second.first - (flags & 0x10 ? 0x2000 : 0);
-		}
-
-		return result;
+		return m_used;
 	}
 
 	u32 block_t::used()
 	{
-		vm::writer_lock lock(0);
-
-		return imp_used(lock);
+		return m_used;
 	}
 
 	static bool _test_map(u32 addr, u32 size)
@@ -4,8 +4,8 @@
 #include <functional>
 #include <memory>
 #include "Utilities/VirtualMemory.h"
+#include "Utilities/mutex.h"
 
-class shared_mutex;
 class cpu_thread;
 class notifier;
 
@@ -148,11 +148,26 @@ namespace vm
 		// Mapped regions: addr -> shm handle
 		std::map<u32, std::pair<u32, std::shared_ptr<utils::shm>>> m_map;
 
+		// Free space index: addr -> size
+		std::map<u32, u32> m_free;
+
+		// Allocated memory (without guard pages)
+		atomic_t<u32> m_used{0};
+
+		// Protects m_map and free space index (doesn't require vm::writer_lock for the search)
+		shared_mutex m_mutex;
+
 		// Common mapped region for special cases
 		std::shared_ptr<utils::shm> m_common;
 
 		bool try_alloc(u32 addr, u8 flags, u32 size, std::shared_ptr<utils::shm>&&);
 
+		// Remove range from the index (returns false if not entirely free)
+		bool take_free(u32 addr, u32 size);
+
+		// Add range to the index, merge with neighbours
+		void add_free(u32 addr, u32 size);
+
 	public:
 		block_t(u32 addr, u32 size, u64 flags = 0);
 
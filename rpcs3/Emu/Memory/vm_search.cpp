@@ -0,0 +1,264 @@
+#include "stdafx.h"
+#include "vm_search.h"
+#include "Utilities/Thread.h"
+#include "Utilities/asm.h"
+
+#include <thread>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace vm
+{
+	static int hex_digit(char c)
+	{
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	search_pattern search_pattern::from_hex(const std::string& str)
+	{
+		search_pattern result;
+
+		std::string digits;
+
+		for (char c : str)
+		{
+			if (c != ' ' && c != '\t')
+			{
+				digits += c;
+			}
+		}
+
+		if (digits.size() % 2)
+		{
+			return {};
+		}
+
+		for (std::size_t i = 0; i < digits.size(); i += 2)
+		{
+			if (digits[i] == '?' && digits[i + 1] == '?')
+			{
+				result.data.push_back(0);
+				result.mask.push_back(0);
+				continue;
+			}
+
+			const int hi = hex_digit(digits[i]);
+			const int lo = hex_digit(digits[i + 1]);
+
+			if (hi < 0 || lo < 0)
+			{
+				return {};
+			}
+
+			result.data.push_back(static_cast<u8>(hi << 4 | lo));
+			result.mask.push_back(0xff);
+		}
+
+		return result;
+	}
+
+	search_pattern search_pattern::from_string(const std::string& str)
+	{
+		search_pattern result;
+		result.data.assign(str.begin(), str.end());
+		result.mask.assign(str.size(), 0xff);
+		return result;
+	}
+
+	bool search_pattern::match(const u8* ptr) const
+	{
+		for (std::size_t i = 0; i < data.size(); i++)
+		{
+			if ((ptr[i] & mask[i]) != data[i])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Call func(i) for every ptr[i] == value, i < count
+	template <typename F>
+	static void scan_byte(const u8* ptr, u32 count, u8 value, F&& func)
+	{
+		u32 i = 0;
+
+#ifdef __AVX2__
+		const __m256i value32 = _mm256_set1_epi8(value);
+
+		for (; i + 32 <= count; i += 32)
+		{
+			u32 bits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i)), value32));
+
+			for (; bits; bits &= bits - 1)
+			{
+				func(i + utils::cnttz32(bits, true));
+			}
+		}
+#endif
+
+		const __m128i value16 = _mm_set1_epi8(value);
+
+		for (; i + 16 <= count; i += 16)
+		{
+			u32 bits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i)), value16));
+
+			for (; bits; bits &= bits - 1)
+			{
+				func(i + utils::cnttz32(bits, true));
+			}
+		}
+
+		for (; i < count; i++)
+		{
+			if (ptr[i] == value)
+			{
+				func(i);
+			}
+		}
+	}
+
+	std::vector<u32> search(const search_pattern& pattern, u32 max_results)
+	{
+		std::vector<u32> result;
+
+		const u32 size = ::size32(pattern.data);
+		const u32 align = std::max<u32>(pattern.align, 1);
+
+		// First byte which must match exactly (used as a filter)
+		const u32 anchor = static_cast<u32>(std::find(pattern.mask.begin(), pattern.mask.end(), 0xff) - pattern.mask.begin());
+
+		if (!size || pattern.mask.size() != size || anchor == size || !max_results)
+		{
+			return result;
+		}
+
+		// Search area: start address and the number of candidates
+		struct chunk_t
+		{
+			u32 addr;
+			u32 count;
+		};
+
+		std::vector<chunk_t> chunks;
+
+		// Chunk size for worker threads
+		constexpr u32 chunk_size = 16 * 1024 * 1024;
+
+		// Prevent unmapping during the search
+		vm::reader_lock lock;
+
+		for (u64 addr = 0; addr < 0x100000000;)
+		{
+			if (!vm::check_addr(static_cast<u32>(addr), 4096, page_allocated))
+			{
+				addr += 4096;
+				continue;
+			}
+
+			// Find contiguous mapped range
+			u64 end = addr + 4096;
+
+			while (end < 0x100000000 && vm::check_addr(static_cast<u32>(end), 4096, page_allocated))
+			{
+				end += 4096;
+			}
+
+			for (u64 pos = addr; pos + size <= end; pos += chunk_size)
+			{
+				chunks.push_back({static_cast<u32>(pos), static_cast<u32>(std::min<u64>(chunk_size, end - size + 1 - pos))});
+			}
+
+			addr = end;
+		}
+
+		if (chunks.empty())
+		{
+			return result;
+		}
+
+		std::vector<std::vector<u32>> found(chunks.size());
+		atomic_t<u32> next{0};
+		atomic_t<u32> total{0};
+
+		// Stop taking chunks once enough results are found, but finish every chunk taken:
+		// processed chunks are always a prefix, so the first max_results addresses don't depend on thread timing
+		auto work = [&]()
+		{
+			for (u32 i; total.load() < max_results && (i = next++) < chunks.size();)
+			{
+				const chunk_t& chunk = chunks[i];
+				const u8* base = vm::g_sudo_addr + chunk.addr;
+
+				scan_byte(base + anchor, chunk.count, pattern.data[anchor], [&](u32 pos)
+				{
+					if ((chunk.addr + pos) % align == 0 && pattern.match(base + pos))
+					{
+						found[i].push_back(chunk.addr + pos);
+					}
+				});
+
+				total += ::size32(found[i]);
+			}
+		};
+
+		const u32 count = std::min<u32>(std::max<u32>(std::thread::hardware_concurrency(), 1), ::size32(chunks));
+
+		std::vector<std::unique_ptr<named_thread<std::function<void()>>>> workers;
+
+		for (u32 i = 1; i < count; i++)
+		{
+			workers.emplace_back(std::make_unique<named_thread<std::function<void()>>>(fmt::format("Memory Search %u", i), work));
+		}
+
+		work();
+
+		for (auto& worker : workers)
+		{
+			(*worker)();
+		}
+
+		// Merge in chunk order (sorted by address)
+		for (auto& addrs : found)
+		{
+			result.insert(result.end(), addrs.begin(), addrs.end());
+		}
+
+		if (result.size() > max_results)
+		{
+			result.resize(max_results);
+		}
+
+		return result;
+	}
+
+	std::vector<u32> search_narrow(const search_pattern& pattern, const std::vector<u32>& previous)
+	{
+		std::vector<u32> result;
+
+		const u32 size = ::size32(pattern.data);
+
+		if (!size || pattern.mask.size() != size)
+		{
+			return result;
+		}
+
+		vm::reader_lock lock;
+
+		for (u32 addr : previous)
+		{
+			if (u64{addr} + size <= 0x100000000 && vm::check_addr(addr, size, page_allocated) && pattern.match(vm::g_sudo_addr + addr))
+			{
+				result.push_back(addr);
+			}
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "vm.h"
+
+#include <string>
+#include <vector>
+
+namespace vm
+{
+	// Byte pattern for guest memory search
+	struct search_pattern
+	{
+		std::vector<u8> data;
+
+		// Byte mask (0x00 for wildcards, 0xff for exact match)
+		std::vector<u8> mask;
+
+		// Required alignment of the results
+		u32 align = 1;
+
+		// Parse hex byte string ("DE AD ?? EF"), returns empty pattern on error
+		static search_pattern from_hex(const std::string& str);
+
+		// Exact string (without null terminator)
+		static search_pattern from_string(const std::string& str);
+
+		// Big-endian value (integer or floating point), naturally aligned
+		template <typename T>
+		static search_pattern from_value(const T& value)
+		{
+			const be_t<T> data = value;
+
+			search_pattern result;
+			result.data.resize(sizeof(T));
+			result.mask.assign(sizeof(T), 0xff);
+			result.align = sizeof(T);
+			std::memcpy(result.data.data(), &data, sizeof(T));
+			return result;
+		}
+
+		bool empty() const
+		{
+			return data.empty();
+		}
+
+		// Compare with host memory (at least data.size() bytes must be available)
+		bool match(const u8* ptr) const;
+	};
+
+	// Search all mapped memory (returns sorted addresses)
+	std::vector<u32> search(const search_pattern& pattern, u32 max_results = -1);
+
+	// Keep only those previous results which match the pattern now
+	std::vector<u32> search_narrow(const search_pattern& pattern, const std::vector<u32>& previous);
+}
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "BufferUtils.h"
+#include "index_decoder.h"
 #include "../rsx_methods.h"
 #include "Utilities/sysinfo.h"
 
@@ -15,6 +16,24 @@ const bool s_use_ssse3 =
 #define _mm_shuffle_epi8
 #endif
 
+const bool s_use_sse4_1 =
+#ifdef _MSC_VER
+	utils::has_sse41();
+#elif __SSE4_1__
+	true;
+#else
+	false;
+#endif
+
+const bool s_use_avx2 =
+#ifdef _MSC_VER
+	utils::has_avx2();
+#elif __AVX2__
+	true;
+#else
+	false;
+#endif
+
 namespace
 {
 	// FIXME: GSL as_span break build if template parameter is non const with current revision.
@@ -536,143 +555,6 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	}
 }
 
-namespace
-{
-template<typename T>
-std::tuple<u32, u32, u32> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<u32> dst, bool is_primitive_restart_enabled, u32 primitive_restart_index, u32 base_index)
-{
-	u32 min_index = -1;
-	u32 max_index = 0;
-
-	verify(HERE), (dst.size_bytes() >= src.size_bytes());
-
-	u32 dst_idx = 0;
-	for (T index : src)
-	{
-		if (is_primitive_restart_enabled && (u32)index == primitive_restart_index)
-		{
-			// List types do not need primitive restart. Just skip over this instead
-			if (rsx::method_registers.current_draw_clause.is_disjoint_primitive)
-				continue;
-
-			dst[dst_idx++] = -1u;
-		}
-		else
-		{
-			const u32 new_index = rsx::get_index_from_base((u32)index, base_index);
-			max_index = std::max(max_index, new_index);
-			min_index = std::min(min_index, new_index);
-			dst[dst_idx++] = new_index;
-		}
-	}
-	return std::make_tuple(min_index, max_index, dst_idx);
-}
-
-template<typename T>
-std::tuple<u32, u32, u32> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> src, gsl::span<u32> dst, bool is_primitive_restart_enabled, u32 primitive_restart_index, u32 base_index)
-{
-	const u32 invalid_index = -1u;
-
-	u32 min_index = invalid_index;
-	u32 max_index = 0;
-
-	verify(HERE), (dst.size() >= 3 * (src.size() - 2));
-
-	u32 dst_idx = 0;
-	u32 src_idx = 0;
-
-	bool needs_anchor = true;
-	u32 anchor = invalid_index;
-	u32 last_index = invalid_index;
-
-	for (size_t src_idx = 0; src_idx < src.size(); ++src_idx)
-	{
-		u32 index = src[src_idx];
-		index = rsx::get_index_from_base(index, base_index);
-
-		if (needs_anchor)
-		{
-			if (is_primitive_restart_enabled && (u32)src[src_idx] == primitive_restart_index)
-				continue;
-
-			anchor = index;
-			needs_anchor = false;
-			continue;
-		}
-
-		if (is_primitive_restart_enabled && (u32)src[src_idx] == primitive_restart_index)
-		{
-			needs_anchor = true;
-			last_index = invalid_index;
-			continue;
-		}
-
-		max_index = std::max(max_index, index);
-		min_index = std::min(min_index, index);
-
-		if (last_index == invalid_index)
-		{
-			//Need at least one anchor and one outer index to create a triangle
-			last_index = index;
-			continue;
-		}
-
-		dst[dst_idx++] = anchor;
-		dst[dst_idx++] = last_index;
-		dst[dst_idx++] = index;
-
-		last_index = index;
-	}
-
-	return std::make_tuple(min_index, max_index, dst_idx);
-}
-
-template<typename T>
-std::tuple<u32, u32, u32> expand_indexed_quads(gsl::span<to_be_t<const T>> src, gsl::span<u32> dst, bool is_primitive_restart_enabled, u32 primitive_restart_index, u32 base_index)
-{
-	u32 min_index = -1;
-	u32 max_index = 0;
-
-	verify(HERE), (4 * dst.size_bytes() >= 6 * src.size_bytes());
-
-	u32 dst_idx = 0;
-	u8 set_size = 0;
-	u32 tmp_indices[4];
-
-	for (int src_idx = 0; src_idx < src.size(); ++src_idx)
-	{
-		u32 index = src[src_idx];
-		index = rsx::get_index_from_base(index, base_index);
-		if (is_primitive_restart_enabled && (u32)src[src_idx] == primitive_restart_index)
-		{
-			//empty temp buffer
-			set_size = 0;
-			continue;
-		}
-
-		tmp_indices[set_size++] = index;
-		max_index = std::max(max_index, index);
-		min_index = std::min(min_index, index);
-
-		if (set_size == 4)
-		{
-			// First triangle
-			dst[dst_idx++] = tmp_indices[0];
-			dst[dst_idx++] = tmp_indices[1];
-			dst[dst_idx++] = tmp_indices[2];
-			// Second triangle
-			dst[dst_idx++] = tmp_indices[2];
-			dst[dst_idx++] = tmp_indices[3];
-			dst[dst_idx++] = tmp_indices[0];
-
-			set_size = 0;
-		}
-	}
-
-	return std::make_tuple(min_index, max_index, dst_idx);
-}
-}
-
 // Only handle quads and triangle fan now
 bool is_primitive_native(rsx::primitive_type draw_mode)
 {
@@ -793,7 +675,7 @@ namespace
 
 
 	// TODO: Unify indexed and non indexed primitive expansion ?
-	template<typename T>
+	template<typename T, typename Decoder>
 	std::tuple<u32, u32, u32> write_index_array_data_to_buffer_impl(gsl::span<u32> dst,
 		gsl::span<const be_t<T>> src,
 		rsx::primitive_type draw_mode, bool restart_index_enabled, u32 restart_index, const std::vector<std::pair<u32, u32> > &first_count_arguments,
@@ -803,25 +685,49 @@ namespace
 		u32 count;
 		std::tie(first, count) = get_first_count_from_draw_indexed_clause(first_count_arguments);
 
-		if (!expands(draw_mode)) return upload_untouched<T>(src, dst, restart_index_enabled, restart_index, base_index);
+		const rsx::index_decoder_args args{restart_index_enabled, restart_index, base_index};
+
+		// List types do not need primitive restart. Just skip over this instead
+		const bool skip_restart = rsx::method_registers.current_draw_clause.is_disjoint_primitive;
+
+		if (!expands(draw_mode)) return rsx::upload_untouched<T, Decoder>(src, dst, args, skip_restart);
 
 		switch (draw_mode)
 		{
 		case rsx::primitive_type::line_loop:
 		{
-			const auto &returnvalue = upload_untouched<T>(src, dst, restart_index_enabled, restart_index, base_index);
+			const auto &returnvalue = rsx::upload_untouched<T, Decoder>(src, dst, args, skip_restart);
 			dst[count] = src[0];
 			return returnvalue;
 		}
 		case rsx::primitive_type::polygon:
 		case rsx::primitive_type::triangle_fan:
-			return expand_indexed_triangle_fan<T>(src, dst, restart_index_enabled, restart_index, base_index);
+			return rsx::expand_indexed_triangle_fan<T, Decoder>(src, dst, args);
 		case rsx::primitive_type::quads:
-			return expand_indexed_quads<T>(src, dst, restart_index_enabled, restart_index, base_index);
+			return rsx::expand_indexed_quads<T, Decoder>(src, dst, args);
 		default:
 			fmt::throw_exception("Unknown draw mode (0x%x)" HERE, (u32)draw_mode);
 		}
 	}
+
+	// Run write_index_array_data_to_buffer_impl with the widest available index decoder
+	template<typename T, typename... Args>
+	std::tuple<u32, u32, u32> write_index_array_data_to_buffer_dispatch(Args&&... args)
+	{
+#if defined(_MSC_VER) || defined(__AVX2__)
+		if (s_use_avx2)
+		{
+			return write_index_array_data_to_buffer_impl<T, rsx::index_decoder_avx2<T>>(std::forward<Args>(args)...);
+		}
+#endif
+#if defined(_MSC_VER) || defined(__SSE4_1__)
+		if (s_use_sse4_1)
+		{
+			return write_index_array_data_to_buffer_impl<T, rsx::index_decoder_sse41<T>>(std::forward<Args>(args)...);
+		}
+#endif
+		return write_index_array_data_to_buffer_impl<T, rsx::index_decoder_scalar<T>>(std::forward<Args>(args)...);
+	}
 }
 
 std::tuple<u32, u32, u32> write_index_array_data_to_buffer(gsl::span<gsl::byte> dst,
@@ -832,10 +738,10 @@ std::tuple<u32, u32, u32> write_index_array_data_to_buffer(gsl::span<gsl::byte>
 	switch (type)
 	{
 	case rsx::index_array_type::u16:
-		return write_index_array_data_to_buffer_impl<u16>(as_span_workaround<u32>(dst),
+		return write_index_array_data_to_buffer_dispatch<u16>(as_span_workaround<u32>(dst),
 			as_const_span<const be_t<u16>>(src), draw_mode, restart_index_enabled, restart_index, first_count_arguments, base_index, expands);
 	case rsx::index_array_type::u32:
-		return write_index_array_data_to_buffer_impl<u32>(as_span_workaround<u32>(dst),
+		return write_index_array_data_to_buffer_dispatch<u32>(as_span_workaround<u32>(dst),
 			as_const_span<const be_t<u32>>(src), draw_mode, restart_index_enabled, restart_index, first_count_arguments, base_index, expands);
 	}
 	fmt::throw_exception("Unknown index type" HERE);
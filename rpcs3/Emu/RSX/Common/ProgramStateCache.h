@@ -192,6 +192,47 @@ protected:
 	fragment_program_type __null_fragment_program;
 	pipeline_storage_type __null_pipeline_handle;
 
+	// Last lookup results for the current programs (avoid rehashing the ucode on every draw)
+	const vertex_program_type* m_last_vertex_program = nullptr;
+	const typename binary_to_fragment_program::value_type* m_last_fragment_program = nullptr;
+
+	/// Same as search_vertex_program, but reuses last result until invalidate_vertex_program_lookup() is called
+	std::tuple<const vertex_program_type&, bool> lookup_vertex_program(const RSXVertexProgram& rsx_vp, bool force_load)
+	{
+		if (m_last_vertex_program)
+		{
+			return std::forward_as_tuple(*m_last_vertex_program, true);
+		}
+
+		const auto result = search_vertex_program(rsx_vp, force_load);
+
+		if (std::get<1>(result) || force_load)
+		{
+			m_last_vertex_program = &std::get<0>(result);
+		}
+
+		return result;
+	}
+
+	/// Same as search_fragment_program, but compares with last result first (ucode lives in guest memory and can be modified in place)
+	std::tuple<const fragment_program_type&, bool> lookup_fragment_program(const RSXFragmentProgram& rsx_fp, bool force_load)
+	{
+		if (m_last_fragment_program && program_hash_util::fragment_program_compare()(m_last_fragment_program->first, rsx_fp))
+		{
+			return std::forward_as_tuple(m_last_fragment_program->second, true);
+		}
+
+		const auto I = m_fragment_shader_cache.find(rsx_fp);
+		if (I != m_fragment_shader_cache.end())
+		{
+			m_last_fragment_program = &*I;
+			return std::forward_as_tuple(I->second, true);
+		}
+
+		m_last_fragment_program = nullptr;
+		return search_fragment_program(rsx_fp, force_load);
+	}
+
 	/// bool here to inform that the program was preexisting.
 	std::tuple<const vertex_program_type&, bool> search_vertex_program(const RSXVertexProgram& rsx_vp, bool force_load = true)
 	{
@@ -319,6 +360,12 @@ public:
 		}
 	};
 
+	// Must be called when the current vertex program is rebuilt
+	void invalidate_vertex_program_lookup()
+	{
+		m_last_vertex_program = nullptr;
+	}
+
 	const vertex_program_type& get_transform_program(const RSXVertexProgram& rsx_vp) const
 	{
 		auto I = m_vertex_shader_cache.find(rsx_vp);
@@ -399,6 +446,7 @@ public:
 		return { (busy || !m_link_queue.empty()), true };
 	}
 
+	/// Find or build the pipeline (doesn't use the last lookup results, can be used for cache preloading)
 	template<typename... Args>
 	pipeline_storage_type& get_graphics_pipeline(
 		const RSXVertexProgram& vertexShader,
@@ -408,9 +456,36 @@ public:
 		Args&& ...args
 		)
 	{
-		const auto &vp_search = search_vertex_program(vertexShader, !allow_async);
-		const auto &fp_search = search_fragment_program(fragmentShader, !allow_async);
+		return get_pipeline(search_vertex_program(vertexShader, !allow_async), search_fragment_program(fragmentShader, !allow_async),
+			vertexShader, fragmentShader, pipelineProperties, allow_async, std::forward<Args>(args)...);
+	}
 
+	/// Same as get_graphics_pipeline, but reuses the last lookup results (for the current draw only, not thread safe)
+	template<typename... Args>
+	pipeline_storage_type& get_current_graphics_pipeline(
+		const RSXVertexProgram& vertexShader,
+		const RSXFragmentProgram& fragmentShader,
+		pipeline_properties& pipelineProperties,
+		bool allow_async,
+		Args&& ...args
+		)
+	{
+		return get_pipeline(lookup_vertex_program(vertexShader, !allow_async), lookup_fragment_program(fragmentShader, !allow_async),
+			vertexShader, fragmentShader, pipelineProperties, allow_async, std::forward<Args>(args)...);
+	}
+
+protected:
+	template<typename... Args>
+	pipeline_storage_type& get_pipeline(
+		const std::tuple<const vertex_program_type&, bool>& vp_search,
+		const std::tuple<const fragment_program_type&, bool>& fp_search,
+		const RSXVertexProgram& vertexShader,
+		const RSXFragmentProgram& fragmentShader,
+		pipeline_properties& pipelineProperties,
+		bool allow_async,
+		Args&& ...args
+		)
+	{
 		const bool already_existing_fragment_program = std::get<1>(fp_search);
 		const bool already_existing_vertex_program = std::get<1>(vp_search);
 
@@ -508,6 +583,7 @@ public:
 		return __null_pipeline_handle;
 	}
 
+public:
 	size_t get_fragment_constants_buffer_size(const RSXFragmentProgram &fragmentShader) const
 	{
 		const auto I = m_fragment_shader_cache.find(fragmentShader);
@@ -0,0 +1,401 @@
+#pragma once
+
+#include "Utilities/types.h"
+#include "Utilities/BEType.h"
+#include "Utilities/StrFmt.h"
+#include "Utilities/GSL.h"
+
+#include <algorithm>
+#include <tuple>
+
+// Index buffer decoding and primitive expansion (shared with rpcs3/benchmarks/index_buffer_bench.cpp)
+namespace rsx
+{
+	struct index_decoder_args
+	{
+		bool restart_enabled;
+		u32 restart_index;
+		u32 base_index;
+	};
+
+	/**
+	* Index decoders: byteswap, rebase and detect primitive restart for a block of indices.
+	* decode() writes block_size rebased indices (-1 for restart) and returns the restart lane bitmask.
+	* Min/max of non-restart indices are accumulated and merged with reduce().
+	*/
+	template <typename T>
+	struct index_decoder_scalar
+	{
+		static constexpr u32 block_size = 1;
+
+		const index_decoder_args args;
+		u32 min_index = -1;
+		u32 max_index = 0;
+
+		index_decoder_scalar(const index_decoder_args& args)
+			: args(args)
+		{
+		}
+
+		u32 decode(const be_t<T>* src, u32* dst)
+		{
+			const u32 index = *src;
+
+			if (args.restart_enabled && index == args.restart_index)
+			{
+				*dst = -1;
+				return 1;
+			}
+
+			// Same as get_index_from_base (carry out of 32 bits doesn't affect the masked result)
+			const u32 new_index = (index + args.base_index) & 0xFFFFF;
+			min_index = std::min(min_index, new_index);
+			max_index = std::max(max_index, new_index);
+			*dst = new_index;
+			return 0;
+		}
+
+		void reduce(u32& _min, u32& _max) const
+		{
+			_min = std::min(_min, min_index);
+			_max = std::max(_max, max_index);
+		}
+	};
+
+#if defined(_MSC_VER) || defined(__SSE4_1__)
+	template <typename T>
+	struct index_decoder_sse41
+	{
+		static constexpr u32 block_size = 4;
+
+		const bool restart_enabled;
+		const __m128i restart_index;
+		const __m128i base_index;
+		__m128i min_index = _mm_set1_epi32(-1);
+		__m128i max_index = _mm_setzero_si128();
+
+		index_decoder_sse41(const index_decoder_args& args)
+			: restart_enabled(args.restart_enabled)
+			, restart_index(_mm_set1_epi32(args.restart_index))
+			, base_index(_mm_set1_epi32(args.base_index))
+		{
+		}
+
+		u32 decode(const be_t<T>* src, u32* dst)
+		{
+			__m128i index;
+
+			if constexpr (sizeof(T) == 2)
+			{
+				const __m128i mask = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+				index = _mm_cvtepu16_epi32(_mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)src), mask));
+			}
+			else
+			{
+				const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+				index = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), mask);
+			}
+
+			const __m128i new_index = _mm_and_si128(_mm_add_epi32(index, base_index), _mm_set1_epi32(0xFFFFF));
+			const __m128i restart = restart_enabled ? _mm_cmpeq_epi32(index, restart_index) : _mm_setzero_si128();
+			const __m128i result = _mm_or_si128(new_index, restart);
+
+			min_index = _mm_min_epu32(min_index, result);
+			max_index = _mm_max_epu32(max_index, _mm_andnot_si128(restart, new_index));
+
+			_mm_storeu_si128((__m128i*)dst, result);
+			return _mm_movemask_ps(_mm_castsi128_ps(restart));
+		}
+
+		void reduce(u32& _min, u32& _max) const
+		{
+			alignas(16) u32 mins[4];
+			alignas(16) u32 maxs[4];
+			_mm_store_si128((__m128i*)mins, min_index);
+			_mm_store_si128((__m128i*)maxs, max_index);
+
+			for (u32 i = 0; i < 4; i++)
+			{
+				_min = std::min(_min, mins[i]);
+				_max = std::max(_max, maxs[i]);
+			}
+		}
+	};
+#endif
+
+#if defined(_MSC_VER) || defined(__AVX2__)
+	template <typename T>
+	struct index_decoder_avx2
+	{
+		static constexpr u32 block_size = 8;
+
+		const bool restart_enabled;
+		const __m256i restart_index;
+		const __m256i base_index;
+		__m256i min_index = _mm256_set1_epi32(-1);
+		__m256i max_index = _mm256_setzero_si256();
+
+		index_decoder_avx2(const index_decoder_args& args)
+			: restart_enabled(args.restart_enabled)
+			, restart_index(_mm256_set1_epi32(args.restart_index))
+			, base_index(_mm256_set1_epi32(args.base_index))
+		{
+		}
+
+		u32 decode(const be_t<T>* src, u32* dst)
+		{
+			__m256i index;
+
+			if constexpr (sizeof(T) == 2)
+			{
+				const __m128i mask = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+				index = _mm256_cvtepu16_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), mask));
+			}
+			else
+			{
+				const __m256i mask = _mm256_broadcastsi128_si256(_mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+				index = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)src), mask);
+			}
+
+			const __m256i new_index = _mm256_and_si256(_mm256_add_epi32(index, base_index), _mm256_set1_epi32(0xFFFFF));
+			const __m256i restart = restart_enabled ? _mm256_cmpeq_epi32(index, restart_index) : _mm256_setzero_si256();
+			const __m256i result = _mm256_or_si256(new_index, restart);
+
+			min_index = _mm256_min_epu32(min_index, result);
+			max_index = _mm256_max_epu32(max_index, _mm256_andnot_si256(restart, new_index));
+
+			_mm256_storeu_si256((__m256i*)dst, result);
+			return _mm256_movemask_ps(_mm256_castsi256_ps(restart));
+		}
+
+		void reduce(u32& _min, u32& _max) const
+		{
+			alignas(32) u32 mins[8];
+			alignas(32) u32 maxs[8];
+			_mm256_store_si256((__m256i*)mins, min_index);
+			_mm256_store_si256((__m256i*)maxs, max_index);
+
+			for (u32 i = 0; i < 8; i++)
+			{
+				_min = std::min(_min, mins[i]);
+				_max = std::max(_max, maxs[i]);
+			}
+		}
+	};
+#endif
+
+	/**
+	* Decode all indices in blocks (the tail is handled by the scalar decoder).
+	* get_output() returns the destination for the next block (at least Decoder::block_size elements),
+	* func(values, restart_mask, count) consumes the decoded block.
+	*/
+	template <typename T, typename Decoder, typename Out, typename F>
+	void decode_indices(gsl::span<to_be_t<const T>> src, const index_decoder_args& args, u32& min_index, u32& max_index, Out&& get_output, F&& func)
+	{
+		Decoder decoder(args);
+		index_decoder_scalar<T> tail(args);
+
+		const u32 count = ::size32(src);
+		u32 i = 0;
+
+		for (; i + Decoder::block_size <= count; i += Decoder::block_size)
+		{
+			u32* values = get_output();
+			func(values, decoder.decode(src.data() + i, values), Decoder::block_size);
+		}
+
+		for (; i < count; i++)
+		{
+			u32* values = get_output();
+			func(values, tail.decode(src.data() + i, values), 1);
+		}
+
+		decoder.reduce(min_index, max_index);
+		tail.reduce(min_index, max_index);
+	}
+
+	/**
+	* Copy rebased indices to dst, returns (min index, max index, index count).
+	* Restart indices are dropped if skip_restart is set (list types do not need primitive restart).
+	*/
+	template <typename T, typename Decoder>
+	std::tuple<u32, u32, u32> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<u32> dst, const index_decoder_args& args, bool skip_restart)
+	{
+		u32 min_index = -1;
+		u32 max_index = 0;
+
+		// Blocks are decoded in place, the output never overtakes the input
+		verify(HERE), (dst.size() >= src.size());
+
+		u32 dst_idx = 0;
+
+		decode_indices<T, Decoder>(src, args, min_index, max_index,
+			[&]() { return dst.data() + dst_idx; },
+			[&](const u32* values, u32 restart, u32 count)
+		{
+			if (!restart || !skip_restart)
+			{
+				dst_idx += count;
+				return;
+			}
+
+			for (u32 i = 0; i < count; i++)
+			{
+				if (!(restart & (1u << i)))
+				{
+					dst[dst_idx++] = values[i];
+				}
+			}
+		});
+
+		return std::make_tuple(min_index, max_index, dst_idx);
+	}
+
+	template <typename T, typename Decoder>
+	std::tuple<u32, u32, u32> expand_indexed_triangle_fan(gsl::span<to_be_t<const T>> src, gsl::span<u32> dst, const index_decoder_args& args)
+	{
+		const u32 invalid_index = -1u;
+
+		u32 min_index = invalid_index;
+		u32 max_index = 0;
+
+		verify(HERE), (dst.size() >= 3 * (src.size() - 2));
+
+		u32 dst_idx = 0;
+
+		bool needs_anchor = true;
+		u32 anchor = invalid_index;
+		u32 last_index = invalid_index;
+
+		alignas(32) u32 block[8];
+
+		decode_indices<T, Decoder>(src, args, min_index, max_index,
+			[&]() { return block; },
+			[&](const u32* values, u32 restart, u32 count)
+		{
+			// Local copies of the state (stores to dst could alias it otherwise)
+			u32* out = dst.data() + dst_idx;
+			u32 _anchor = anchor;
+			u32 _last_index = last_index;
+			bool _needs_anchor = needs_anchor;
+
+			if (!restart && !_needs_anchor && _last_index != invalid_index)
+			{
+				// Fast path: every index completes a triangle
+				for (u32 i = 0; i < count; i++)
+				{
+					out[0] = _anchor;
+					out[1] = _last_index;
+					out[2] = _last_index = values[i];
+					out += 3;
+				}
+
+				dst_idx = static_cast<u32>(out - dst.data());
+				last_index = _last_index;
+				return;
+			}
+
+			for (u32 i = 0; i < count; i++)
+			{
+				const u32 index = values[i];
+
+				if (restart & (1u << i))
+				{
+					_needs_anchor = true;
+					_last_index = invalid_index;
+					continue;
+				}
+
+				if (_needs_anchor)
+				{
+					_anchor = index;
+					_needs_anchor = false;
+					continue;
+				}
+
+				if (_last_index == invalid_index)
+				{
+					//Need at least one anchor and one outer index to create a triangle
+					_last_index = index;
+					continue;
+				}
+
+				*out++ = _anchor;
+				*out++ = _last_index;
+				*out++ = index;
+
+				_last_index = index;
+			}
+
+			dst_idx = static_cast<u32>(out - dst.data());
+			anchor = _anchor;
+			last_index = _last_index;
+			needs_anchor = _needs_anchor;
+		});
+
+		return std::make_tuple(min_index, max_index, dst_idx);
+	}
+
+	template <typename T, typename Decoder>
+	std::tuple<u32, u32, u32> expand_indexed_quads(gsl::span<to_be_t<const T>> src, gsl::span<u32> dst, const index_decoder_args& args)
+	{
+		u32 min_index = -1;
+		u32 max_index = 0;
+
+		verify(HERE), (4 * dst.size_bytes() >= 6 * src.size_bytes());
+
+		u32 dst_idx = 0;
+		u8 set_size = 0;
+		u32 tmp_indices[4];
+
+		alignas(32) u32 block[8];
+
+		const auto emit_quad = [&](const u32* quad)
+		{
+			// First triangle
+			dst[dst_idx++] = quad[0];
+			dst[dst_idx++] = quad[1];
+			dst[dst_idx++] = quad[2];
+			// Second triangle
+			dst[dst_idx++] = quad[2];
+			dst[dst_idx++] = quad[3];
+			dst[dst_idx++] = quad[0];
+		};
+
+		decode_indices<T, Decoder>(src, args, min_index, max_index,
+			[&]() { return block; },
+			[&](const u32* values, u32 restart, u32 count)
+		{
+			if (!restart && !set_size && count % 4 == 0)
+			{
+				// Whole quads
+				for (u32 i = 0; i < count; i += 4)
+				{
+					emit_quad(values + i);
+				}
+
+				return;
+			}
+
+			for (u32 i = 0; i < count; i++)
+			{
+				if (restart & (1u << i))
+				{
+					//empty temp buffer
+					set_size = 0;
+					continue;
+				}
+
+				tmp_indices[set_size++] = values[i];
+
+				if (set_size == 4)
+				{
+					emit_quad(tmp_indices);
+					set_size = 0;
+				}
+			}
+		});
+
+		return std::make_tuple(min_index, max_index, dst_idx);
+	}
+}
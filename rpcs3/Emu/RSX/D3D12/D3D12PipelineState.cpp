@@ -54,6 +54,11 @@ void D3D12GSRender::load_program()
 		return std::make_tuple(true, native_pitch);
 	};
 
+	if (m_graphics_state & rsx::pipeline_state::vertex_program_dirty)
+	{
+		m_pso_cache.invalidate_vertex_program_lookup();
+	}
+
 	get_current_vertex_program({}, true, false);
 	get_current_fragment_program_legacy(rtt_lookup_func);
 
@@ -310,7 +315,7 @@ void D3D12GSRender::load_program()
 		}
 	}
 
-	m_current_pso = m_pso_cache.get_graphics_pipeline(current_vertex_program, current_fragment_program, prop, false, m_device.Get(), m_shared_root_signature.Get());
+	m_current_pso = m_pso_cache.get_current_graphics_pipeline(current_vertex_program, current_fragment_program, prop, false, m_device.Get(), m_shared_root_signature.Get());
 	return;
 }
 
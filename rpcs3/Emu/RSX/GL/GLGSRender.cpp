@@ -1159,6 +1159,11 @@ bool GLGSRender::load_program()
 		get_current_fragment_program(fs_sampler_state);
 		verify(HERE), current_fragment_program.valid;
 
+		if (m_graphics_state & rsx::pipeline_state::vertex_program_dirty)
+		{
+			m_prog_buffer.invalidate_vertex_program_lookup();
+		}
+
 		get_current_vertex_program(vs_sampler_state);
 
 		current_vertex_program.skip_vertex_input_check = true;	//not needed for us since decoding is done server side
@@ -1171,7 +1176,7 @@ bool GLGSRender::load_program()
 	}
 
 	void* pipeline_properties = nullptr;
-	m_program = m_prog_buffer.get_graphics_pipeline(current_vertex_program, current_fragment_program, pipeline_properties,
+	m_program = m_prog_buffer.get_current_graphics_pipeline(current_vertex_program, current_fragment_program, pipeline_properties,
 			!g_cfg.video.disable_asynchronous_shader_compiler).get();
 
 	if (m_prog_buffer.check_cache_missed())
@@ -2237,6 +2237,11 @@ bool VKGSRender::load_program()
 		get_current_fragment_program(fs_sampler_state);
 		verify(HERE), current_fragment_program.valid;
 
+		if (m_graphics_state & rsx::pipeline_state::vertex_program_dirty)
+		{
+			m_prog_buffer->invalidate_vertex_program_lookup();
+		}
+
 		get_current_vertex_program(vs_sampler_state);
 
 		m_graphics_state &= ~rsx::pipeline_state::invalidate_pipeline_bits;
@@ -2374,7 +2379,7 @@ bool VKGSRender::load_program()
 	//Load current program from buffer
 	vertex_program.skip_vertex_input_check = true;
 	fragment_program.unnormalized_coords = 0;
-	m_program = m_prog_buffer->get_graphics_pipeline(vertex_program, fragment_program, properties,
+	m_program = m_prog_buffer->get_current_graphics_pipeline(vertex_program, fragment_program, properties,
 			!g_cfg.video.disable_asynchronous_shader_compiler, *m_device, pipeline_layout).get();
 
 	vk::leave_uninterruptible();
@@ -0,0 +1,228 @@
+#include "stdafx.h"
+#include "rsx_cache.h"
+
+namespace rsx
+{
+	// Shader cache archive header
+	struct shader_cache_archive_header
+	{
+		le_t<u32> magic;
+		le_t<u32> version;
+		le_t<u64> reserved;
+	};
+
+	// Shader cache archive record header (followed by raw data)
+	struct shader_cache_archive_record
+	{
+		le_t<u32> magic;
+		le_t<u32> type;
+		le_t<u32> size;
+		le_t<u32> reserved;
+		le_t<u64> key;
+		le_t<u64> checksum;
+	};
+
+	constexpr u32 s_archive_magic = 0x50435352; // "RSCP"
+	constexpr u32 s_archive_version = 1;
+	constexpr u32 s_record_magic = 0x52435352; // "RSCR"
+
+	// Sanity limit for a single record
+	constexpr u32 s_record_max_size = 0x100000;
+
+	u64 shader_cache_archive::hash(const void* data, std::size_t size, u64 seed)
+	{
+		// FNV-1a
+		u64 result = seed;
+
+		for (std::size_t i = 0; i < size; i++)
+		{
+			result ^= static_cast<const u8*>(data)[i];
+			result *= 0x100000001b3ull;
+		}
+
+		return result;
+	}
+
+	static u64 record_checksum(u32 type, u64 key, const void* data, u32 size)
+	{
+		const le_t<u64> _key = key;
+		const le_t<u32> _type = type;
+
+		u64 result = shader_cache_archive::hash(&_type, sizeof(_type));
+		result = shader_cache_archive::hash(&_key, sizeof(_key), result);
+		return shader_cache_archive::hash(data, size, result);
+	}
+
+	shader_cache_archive::shader_cache_archive(const std::string& loc)
+		: m_file(loc, fs::read + fs::write + fs::create)
+	{
+		if (!m_file)
+		{
+			LOG_ERROR(RSX, "Shader cache: failed to open %s (%s)", loc, fs::g_tls_error);
+			return;
+		}
+
+		shader_cache_archive_header header{};
+
+		if (m_file.size() < sizeof(header) || !m_file.read(header) || header.magic != s_archive_magic || header.version != s_archive_version)
+		{
+			if (m_file.size())
+			{
+				LOG_ERROR(RSX, "Shader cache: invalid or outdated file cleared: %s", loc);
+			}
+
+			header.magic = s_archive_magic;
+			header.version = s_archive_version;
+			header.reserved = 0;
+
+			m_file.trunc(0);
+			m_file.seek(0);
+			m_file.write(header);
+		}
+
+		const u64 file_size = m_file.size();
+
+		// Validate records and build the index
+		m_end = fs::map_records(m_file, m_view, sizeof(header), [&](u64 pos, const uchar* data, u64 avail) -> u64
+		{
+			shader_cache_archive_record rec;
+
+			if (avail < sizeof(rec))
+			{
+				return 0;
+			}
+
+			std::memcpy(&rec, data, sizeof(rec));
+
+			const u64 size = sizeof(rec) + rec.size;
+
+			if (rec.magic != s_record_magic || rec.type == 0 || rec.type > pipeline || rec.size == 0 || rec.size > s_record_max_size || size > avail)
+			{
+				return 0;
+			}
+
+			// Detect torn writes and corrupted data
+			if (record_checksum(rec.type, rec.key, data + sizeof(rec), rec.size) != rec.checksum)
+			{
+				return 0;
+			}
+
+			if (m_index[rec.type].emplace(rec.key, pos).second && rec.type == pipeline)
+			{
+				m_pipelines.push_back(pos);
+			}
+
+			return size;
+		});
+
+		if (!m_view)
+		{
+			LOG_ERROR(RSX, "Shader cache: failed to map %s (%s), cache disabled", loc, fs::g_tls_error);
+			m_file.close();
+			m_pipelines.clear();
+
+			for (auto& index : m_index)
+			{
+				index.clear();
+			}
+
+			return;
+		}
+
+		if (m_end < file_size)
+		{
+			LOG_ERROR(RSX, "Shader cache: damaged record at 0x%x (file size 0x%x), the rest is discarded", m_end, file_size);
+		}
+
+		m_view_end = m_end;
+	}
+
+	shader_cache_archive::~shader_cache_archive()
+	{
+	}
+
+	bool shader_cache_archive::contains(u32 type, u64 key)
+	{
+		reader_lock lock(m_mutex);
+
+		return m_index[type].count(key) != 0;
+	}
+
+	bool shader_cache_archive::add(u32 type, u64 key, const void* data, u32 size)
+	{
+		if (!m_file || !size || size > s_record_max_size)
+		{
+			return false;
+		}
+
+		std::lock_guard lock(m_mutex);
+
+		if (m_index[type].count(key))
+		{
+			return false;
+		}
+
+		shader_cache_archive_record rec;
+		rec.magic = s_record_magic;
+		rec.type = type;
+		rec.size = size;
+		rec.reserved = 0;
+		rec.key = key;
+		rec.checksum = record_checksum(type, key, data, size);
+
+		// Write the whole record at once
+		std::vector<u8> buf(sizeof(rec) + size);
+		std::memcpy(buf.data(), &rec, sizeof(rec));
+		std::memcpy(buf.data() + sizeof(rec), data, size);
+
+		m_file.seek(m_end);
+
+		if (m_file.write(buf.data(), buf.size()) != buf.size())
+		{
+			LOG_ERROR(RSX, "Shader cache: failed to write record 0x%llx (%s)", key, fs::g_tls_error);
+			m_file.trunc(m_end);
+			return false;
+		}
+
+		m_index[type].emplace(key, m_end);
+		m_end += buf.size();
+		return true;
+	}
+
+	shader_cache_archive::record_view shader_cache_archive::find(u32 type, u64 key)
+	{
+		reader_lock lock(m_mutex);
+
+		const auto found = m_index[type].find(key);
+
+		// Only records mapped at the time of opening are accessible
+		if (found == m_index[type].end() || found->second >= m_view_end)
+		{
+			return {};
+		}
+
+		shader_cache_archive_record rec;
+		std::memcpy(&rec, m_view.data() + found->second, sizeof(rec));
+
+		return {rec.key, rec.size, m_view.data() + found->second + sizeof(rec)};
+	}
+
+	std::vector<shader_cache_archive::record_view> shader_cache_archive::get_pipelines()
+	{
+		std::vector<record_view> result;
+
+		reader_lock lock(m_mutex);
+
+		result.reserve(m_pipelines.size());
+
+		for (u64 pos : m_pipelines)
+		{
+			shader_cache_archive_record rec;
+			std::memcpy(&rec, m_view.data() + pos, sizeof(rec));
+
+			result.push_back({rec.key, rec.size, m_view.data() + pos + sizeof(rec)});
+		}
+
+		return result;
+	}
+}
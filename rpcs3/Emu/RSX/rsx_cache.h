@@ -9,6 +9,8 @@
 #include "Common/texture_cache_checker.h"
 
 #include "rsx_utils.h"
+#include "Utilities/File.h"
+#include "Utilities/mutex.h"
 #include <thread>
 
 namespace rsx
@@ -370,6 +372,70 @@ namespace rsx
 
 
 
+	// Single-file shader cache storage (append-only list of checksummed records)
+	class shader_cache_archive
+	{
+	public:
+		enum record_type : u32
+		{
+			vertex_program = 1,
+			fragment_program = 2,
+			pipeline = 3,
+		};
+
+		// Record reference (points into the mapped file)
+		struct record_view
+		{
+			u64 key;
+			u32 size;
+			const uchar* data;
+		};
+
+	private:
+		fs::file m_file;
+
+		// Mapped file contents (valid records at the time of opening)
+		fs::file_view m_view;
+
+		// Record indices (key -> record offset) for every record type
+		std::unordered_map<u64, u64> m_index[4];
+
+		// Pipeline records in the mapped file, in order of addition
+		std::vector<u64> m_pipelines;
+
+		// End of the mapped records
+		u64 m_view_end = 0;
+
+		// End of the last valid record
+		u64 m_end = 0;
+
+		shared_mutex m_mutex;
+
+	public:
+		shader_cache_archive(const std::string& loc);
+
+		~shader_cache_archive();
+
+		explicit operator bool() const
+		{
+			return m_file.operator bool();
+		}
+
+		// FNV-1a hash
+		static u64 hash(const void* data, std::size_t size, u64 seed = 0xcbf29ce484222325ull);
+
+		bool contains(u32 type, u64 key);
+
+		// Append record unless the key is already stored
+		bool add(u32 type, u64 key, const void* data, u32 size);
+
+		// Find record in the mapped file (data is null if not found)
+		record_view find(u32 type, u64 key);
+
+		// Get all pipeline records in the mapped file
+		std::vector<record_view> get_pipelines();
+	};
+
 	template <typename pipeline_storage_type, typename backend_storage>
 	class shaders_cache
 	{
@@ -404,10 +470,98 @@ namespace rsx
 		std::string version_prefix;
 		std::string root_path;
 		std::string pipeline_class_name;
-		std::unordered_map<u64, std::vector<u8>> fragment_program_data;
+
+		// Opened on first use, keeps the mapping referenced by the loaded fragment programs
+		std::unique_ptr<shader_cache_archive> m_archive;
 
 		backend_storage& m_storage;
 
+		std::string get_archive_path() const
+		{
+			return root_path + "/pipelines/" + pipeline_class_name + "/" + version_prefix + ".pack";
+		}
+
+		std::string get_legacy_path() const
+		{
+			return root_path + "/pipelines/" + pipeline_class_name + "/" + version_prefix;
+		}
+
+		// Import pipelines stored as separate files by older versions
+		void import_legacy()
+		{
+			const std::string directory_path = get_legacy_path();
+
+			if (!fs::is_dir(directory_path))
+			{
+				return;
+			}
+
+			u32 imported = 0;
+
+			for (const auto& entry : fs::dir(directory_path))
+			{
+				if (entry.is_directory || entry.size != sizeof(pipeline_data))
+				{
+					continue;
+				}
+
+				pipeline_data data;
+
+				if (fs::file(directory_path + "/" + entry.name).read(&data, sizeof(data)) != sizeof(data))
+				{
+					continue;
+				}
+
+				const fs::file vp(root_path + fmt::format("/raw/%llX.vp", data.vertex_program_hash));
+				const fs::file fp(root_path + fmt::format("/raw/%llX.fp", data.fragment_program_hash));
+
+				if (!vp || !fp)
+				{
+					LOG_ERROR(RSX, "shader cache: raw programs of %s not found, entry skipped", entry.name);
+					continue;
+				}
+
+				if (!m_archive->contains(shader_cache_archive::vertex_program, data.vertex_program_hash))
+				{
+					const std::vector<u8> bytes = vp.to_vector<u8>();
+					m_archive->add(shader_cache_archive::vertex_program, data.vertex_program_hash, bytes.data(), ::size32(bytes));
+				}
+
+				if (!m_archive->contains(shader_cache_archive::fragment_program, data.fragment_program_hash))
+				{
+					const std::vector<u8> bytes = fp.to_vector<u8>();
+					m_archive->add(shader_cache_archive::fragment_program, data.fragment_program_hash, bytes.data(), ::size32(bytes));
+				}
+
+				if (m_archive->add(shader_cache_archive::pipeline, get_pipeline_key(data), &data, sizeof(data)))
+				{
+					imported++;
+				}
+			}
+
+			LOG_NOTICE(RSX, "shader cache: imported %u pipeline objects from %s", imported, directory_path);
+		}
+
+		static u64 get_pipeline_key(const pipeline_data& data)
+		{
+			u64 state_hash = 0;
+			state_hash ^= rpcs3::hash_base<u32>(data.vp_ctrl);
+			state_hash ^= rpcs3::hash_base<u32>(data.fp_ctrl);
+			state_hash ^= rpcs3::hash_base<u32>(data.vp_texture_dimensions);
+			state_hash ^= rpcs3::hash_base<u32>(data.fp_texture_dimensions);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_unnormalized_coords);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_height);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_pixel_layout);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_lighting_flags);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_shadow_textures);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_redirected_textures);
+			state_hash ^= rpcs3::hash_base<u16>(data.fp_alphakill_mask);
+			state_hash ^= rpcs3::hash_base<u64>(data.fp_zfunc_mask);
+
+			const u64 key[4] = {data.vertex_program_hash, data.fragment_program_hash, data.pipeline_storage_hash, state_hash};
+			return shader_cache_archive::hash(key, sizeof(key));
+		}
+
 	public:
 
 		struct progress_dialog_helper
@@ -506,37 +660,36 @@ namespace rsx
 				return;
 			}
 
-			std::string directory_path = root_path + "/pipelines/" + pipeline_class_name + "/" + version_prefix;
+			fs::create_path(root_path + "/pipelines/" + pipeline_class_name);
 
-			if (!fs::is_dir(directory_path))
-			{
-				fs::create_path(directory_path);
-				fs::create_path(root_path + "/raw");
+			const std::string archive_path = get_archive_path();
+			const bool archive_exists = fs::is_file(archive_path);
 
+			m_archive = std::make_unique<shader_cache_archive>(archive_path);
+
+			if (!*m_archive)
+			{
+				m_archive.reset();
 				return;
 			}
 
-			fs::dir root = fs::dir(directory_path);
-
-			u32 entry_count = 0;
-			std::vector<fs::dir_entry> entries;
-			for (auto It = root.begin(); It != root.end(); ++It, entry_count++)
+			if (!archive_exists)
 			{
-				fs::dir_entry tmp = *It;
-
-				if (tmp.name == "." || tmp.name == "..")
-					continue;
+				import_legacy();
 
-				entries.push_back(tmp);
+				// Reopen to map imported records
+				m_archive.reset();
+				m_archive = std::make_unique<shader_cache_archive>(archive_path);
 			}
 
-			if ((entry_count = (u32)entries.size()) <= 2)
-				return;
+			const auto entries = m_archive->get_pipelines();
 
-			root.rewind();
+			u32 entry_count = ::size32(entries);
 
-			// Invalid pipeline entries to be removed
-			std::vector<std::string> invalid_entries;
+			if (entry_count == 0)
+				return;
+
+			u32 invalid_count = 0;
 
 			// Progress dialog
 			std::unique_ptr<progress_dialog_helper> fallback_dlg;
@@ -564,22 +717,20 @@ namespace rsx
 
 			for (u32 i = 0; (i < entry_count) && !Emu.IsStopped(); i++)
 			{
-				fs::dir_entry tmp = entries[i];
+				const auto& entry = entries[i];
 
-				const auto filename = directory_path + "/" + tmp.name;
-				std::vector<u8> bytes;
-				fs::file f(filename);
-				if (f.size() != sizeof(pipeline_data))
+				pipeline_data data;
+				if (entry.size != sizeof(pipeline_data) || (std::memcpy(&data, entry.data, sizeof(data)), !has_programs(data)))
 				{
-					LOG_ERROR(RSX, "Cached pipeline object %s is not binary compatible with the current shader cache", tmp.name.c_str());
-					invalid_entries.push_back(filename);
-					continue;
+					LOG_ERROR(RSX, "Cached pipeline object 0x%llx is not binary compatible with the current shader cache", entry.key);
+					invalid_count++;
+				}
+				else
+				{
+					auto unpacked = unpack(data);
+					m_storage.preload_programs(std::get<1>(unpacked), std::get<2>(unpacked));
+					unpackeds.push_back(unpacked);
 				}
-				f.read<u8>(bytes, f.size());
-
-				auto unpacked = unpack(*(pipeline_data*)bytes.data());
-				m_storage.preload_programs(std::get<1>(unpacked), std::get<2>(unpacked));
-				unpackeds.push_back(unpacked);
 
 				// Only update the screen at about 10fps since updating it everytime slows down the process
 				std::chrono::time_point<steady_clock> now = std::chrono::steady_clock::now();
@@ -593,6 +744,8 @@ namespace rsx
 				}
 			}
 
+			entry_count = ::size32(unpackeds);
+
 			atomic_t<u32> processed(0);
 			std::function<void(u32)> shader_comp_worker = [&](u32 index)
 			{
@@ -656,14 +809,9 @@ namespace rsx
 				}
 			}
 
-			if (!invalid_entries.empty())
+			if (invalid_count)
 			{
-				for (const auto &filename : invalid_entries)
-				{
-					fs::remove_file(filename);
-				}
-
-				LOG_NOTICE(RSX, "shader cache: %d entries were marked as invalid and removed", invalid_entries.size());
+				LOG_NOTICE(RSX, "shader cache: %u entries were marked as invalid and skipped", invalid_count);
 			}
 
 			dlg->refresh();
@@ -683,49 +831,47 @@ namespace rsx
 				return;
 			}
 
+			if (!m_archive)
+			{
+				fs::create_path(root_path + "/pipelines/" + pipeline_class_name);
+
+				m_archive = std::make_unique<shader_cache_archive>(get_archive_path());
+			}
+
+			if (!*m_archive)
+			{
+				return;
+			}
+
 			pipeline_data data = pack(pipeline, vp, fp);
-			std::string fp_name = root_path + "/raw/" + fmt::format("%llX.fp", data.fragment_program_hash);
-			std::string vp_name = root_path + "/raw/" + fmt::format("%llX.vp", data.vertex_program_hash);
 
-			if (!fs::is_file(fp_name))
+			// Raw programs are shared between pipelines and only stored once
+			if (!m_archive->contains(shader_cache_archive::fragment_program, data.fragment_program_hash))
 			{
-				fs::file(fp_name, fs::rewrite).write(fp.addr, fp.ucode_length);
+				m_archive->add(shader_cache_archive::fragment_program, data.fragment_program_hash, fp.addr, fp.ucode_length);
 			}
 
-			if (!fs::is_file(vp_name))
+			if (!m_archive->contains(shader_cache_archive::vertex_program, data.vertex_program_hash))
 			{
-				fs::file(vp_name, fs::rewrite).write<u32>(vp.data);
+				m_archive->add(shader_cache_archive::vertex_program, data.vertex_program_hash, vp.data.data(), ::size32(vp.data) * sizeof(u32));
 			}
 
-			u64 state_hash = 0;
-			state_hash ^= rpcs3::hash_base<u32>(data.vp_ctrl);
-			state_hash ^= rpcs3::hash_base<u32>(data.fp_ctrl);
-			state_hash ^= rpcs3::hash_base<u32>(data.vp_texture_dimensions);
-			state_hash ^= rpcs3::hash_base<u32>(data.fp_texture_dimensions);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_unnormalized_coords);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_height);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_pixel_layout);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_lighting_flags);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_shadow_textures);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_redirected_textures);
-			state_hash ^= rpcs3::hash_base<u16>(data.fp_alphakill_mask);
-			state_hash ^= rpcs3::hash_base<u64>(data.fp_zfunc_mask);
+			m_archive->add(shader_cache_archive::pipeline, get_pipeline_key(data), &data, sizeof(pipeline_data));
+		}
 
-			std::string pipeline_file_name = fmt::format("%llX+%llX+%llX+%llX.bin", data.vertex_program_hash, data.fragment_program_hash, data.pipeline_storage_hash, state_hash);
-			std::string pipeline_path = root_path + "/pipelines/" + pipeline_class_name + "/" + version_prefix + "/" + pipeline_file_name;
-			fs::file(pipeline_path, fs::rewrite).write(&data, sizeof(pipeline_data));
+		bool has_programs(const pipeline_data& data)
+		{
+			return m_archive->find(shader_cache_archive::vertex_program, data.vertex_program_hash).data &&
+				m_archive->find(shader_cache_archive::fragment_program, data.fragment_program_hash).data;
 		}
 
 		RSXVertexProgram load_vp_raw(u64 program_hash)
 		{
-			std::vector<u32> data;
-			std::string filename = fmt::format("%llX.vp", program_hash);
-
-			fs::file f(root_path + "/raw/" + filename);
-			f.read<u32>(data, f.size() / sizeof(u32));
+			const auto raw = m_archive->find(shader_cache_archive::vertex_program, program_hash);
 
 			RSXVertexProgram vp = {};
-			vp.data = data;
+			vp.data.resize(raw.size / sizeof(u32));
+			std::memcpy(vp.data.data(), raw.data, vp.data.size() * sizeof(u32));
 			vp.skip_vertex_input_check = true;
 
 			return vp;
@@ -733,16 +879,12 @@ namespace rsx
 
 		RSXFragmentProgram load_fp_raw(u64 program_hash)
 		{
-			std::vector<u8> data;
-			std::string filename = fmt::format("%llX.fp", program_hash);
-
-			fs::file f(root_path + "/raw/" + filename);
-			f.read<u8>(data, f.size());
+			const auto raw = m_archive->find(shader_cache_archive::fragment_program, program_hash);
 
+			// Fragment program ucode is used directly from the mapped file
 			RSXFragmentProgram fp = {};
-			fragment_program_data[program_hash] = data;
-			fp.addr = fragment_program_data[program_hash].data();
-			fp.ucode_length = (u32)data.size();
+			fp.addr = const_cast<uchar*>(raw.data);
+			fp.ucode_length = raw.size;
 
 			return fp;
 		}
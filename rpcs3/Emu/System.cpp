@@ -13,6 +13,7 @@
 #include "Emu/Cell/lv2/sys_sync.h"
 #include "Emu/Cell/lv2/sys_prx.h"
 #include "Emu/Cell/lv2/sys_rsx.h"
+#include "Emu/Cell/lv2/sys_timer.h"
 
 #include "Emu/IdManager.h"
 #include "Emu/RSX/GSRender.h"
@@ -61,6 +62,7 @@ extern void ppu_unload_prx(const lv2_prx&);
 extern std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object&, const std::string&);
 
 extern void network_thread_init();
+extern void lv2_fs_report_stats();
 
 fs::file g_tty;
 atomic_t<s64> g_tty_size{0};
@@ -257,6 +259,22 @@ void fmt_class_string<tsx_usage>::format(std::string& out, u64 arg)
 	});
 }
 
+template <>
+void fmt_class_string<thread_placement>::format(std::string& out, u64 arg)
+{
+	format_enum(out, arg, [](thread_placement value)
+	{
+		switch (value)
+		{
+		case thread_placement::legacy: return "Legacy";
+		case thread_placement::cache: return "Cache-aware";
+		case thread_placement::numa: return "NUMA node";
+		}
+
+		return unknown;
+	});
+}
+
 template <>
 void fmt_class_string<enter_button_assign>::format(std::string& out, u64 arg)
 {
@@ -699,6 +717,9 @@ void Emulator::Load(bool add_only)
 
 		LOG_NOTICE(LOADER, "Used configuration:\n%s\n", g_cfg.to_string());
 
+		// Set log mode
+		logs::set_deferred(g_cfg.misc.deferred_log);
+
 		// Set RTM usage
 		g_use_rtm = utils::has_rtm() && ((utils::has_mpx() && g_cfg.core.enable_TSX == tsx_usage::enabled) || g_cfg.core.enable_TSX == tsx_usage::forced);
 		if (g_use_rtm && !utils::has_mpx())
@@ -706,6 +727,12 @@ void Emulator::Load(bool add_only)
 			LOG_WARNING(GENERAL, "TSX forced by User");
 		}
 
+		// Report host thread placement
+		if (g_cfg.core.thread_scheduler_enabled)
+		{
+			thread_ctrl::init_thread_placement();
+		}
+
 		// Load patches from different locations
 		fxm::check_unlocked<patch_engine>()->append(fs::get_config_dir() + "data/" + m_title_id + "/patch.yml");
 		fxm::check_unlocked<patch_engine>()->append(m_cache_path + "/patch.yml");
@@ -1237,6 +1264,9 @@ void Emulator::Run()
 	m_pause_amend_time = 0;
 	m_state = system_state::running;
 
+	// Serves sys_timer and lv2 timeouts
+	fxm::make<lv2_timer_service>("Timer Service");
+
 	auto on_select = [](u32, cpu_thread& cpu)
 	{
 		cpu.state -= cpu_flag::stop;
@@ -1387,6 +1417,7 @@ void Emulator::Stop(bool restart)
 
 	LOG_NOTICE(GENERAL, "All threads stopped...");
 
+	lv2_fs_report_stats();
 	lv2_obj::cleanup();
 	idm::clear();
 	fxm::clear();
@@ -170,6 +170,13 @@ enum class tsx_usage
 	forced,
 };
 
+enum class thread_placement
+{
+	legacy, // Fixed masks for known CPUs (up to 16 threads)
+	cache, // Group PPU/RSX and each SPU thread group on cores sharing the last level cache
+	numa, // Confine all threads to a single NUMA node
+};
+
 enum enter_button_assign
 {
 	circle = 0, // CELL_SYSUTIL_ENTER_BUTTON_ASSIGN_CIRCLE
@@ -350,7 +357,9 @@ struct cfg_root : cfg::node
 		cfg::_bool llvm_logs{this, "Save LLVM logs"};
 		cfg::string llvm_cpu{this, "Use LLVM CPU"};
 		cfg::_int<0, INT32_MAX> llvm_threads{this, "Max LLVM Compile Threads", 0};
+		cfg::_bool ppu_async_compile{this, "PPU Async Compilation", false}; // Compile PPU modules in background, interpret meanwhile
 		cfg::_bool thread_scheduler_enabled{this, "Enable thread scheduler", thread_scheduler_enabled_def};
+		cfg::_enum<thread_placement> thread_placement_policy{this, "Thread placement", thread_placement::cache};
 		cfg::_bool set_daz_and_ftz{this, "Set DAZ and FTZ", false};
 		cfg::_enum<spu_decoder_type> spu_decoder{this, "SPU Decoder", spu_decoder_type::asmjit};
 		cfg::_bool lower_spu_priority{this, "Lower SPU thread priority"};
@@ -364,6 +373,9 @@ struct cfg_root : cfg::node
 		cfg::_bool spu_accurate_putlluc{this, "Accurate PUTLLUC", false};
 		cfg::_bool spu_verification{this, "SPU Verification", true}; // Should be enabled
 		cfg::_bool spu_cache{this, "SPU Cache", true};
+		cfg::_bool spu_async_compile{this, "SPU Async Compilation", false}; // Compile SPU functions in background, interpret meanwhile (requires shared runtime)
+		cfg::_bool spu_tiered{this, "SPU Tiered Compilation", false}; // Recompile hot ASMJIT functions with LLVM in background (requires shared runtime)
+		cfg::_int<1, 0x7fffffff> spu_tiered_threshold{this, "SPU Tiered Threshold", 10000}; // Number of function entries before recompilation
 		cfg::_enum<tsx_usage> enable_TSX{this, "Enable TSX", tsx_usage::enabled}; // Enable TSX. Forcing this on Haswell/Broadwell CPUs should be used carefully
 		cfg::_bool spu_accurate_xfloat{this, "Accurate xfloat", false};
 
@@ -556,6 +568,7 @@ struct cfg_root : cfg::node
 		cfg::_bool show_shader_compilation_hint{ this, "Show shader compilation hint", true };
 		cfg::_bool use_native_interface{ this, "Use native user interface", true };
 		cfg::_int<1, 65535> gdb_server_port{this, "Port", 2345};
+		cfg::_bool deferred_log{this, "Deferred log formatting"}; // Format simple log messages on the log writer thread
 
 	} misc{this};
 
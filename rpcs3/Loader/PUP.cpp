@@ -1,6 +1,12 @@
 ﻿#include "stdafx.h"
 
 #include "PUP.h"
+#include "TAR.h"
+
+#include "Crypto/unself.h"
+#include "Utilities/Thread.h"
+
+#include <thread>
 
 pup_object::pup_object(const fs::file& file): m_file(file)
 {
@@ -24,6 +30,71 @@ pup_object::pup_object(const fs::file& file): m_file(file)
 	m_file.read(m_hash_tbl);
 }
 
+struct pup_object::file_view : fs::file_base
+{
+	const fs::file& m_file;
+	const std::shared_ptr<std::mutex> m_mutex;
+	const u64 m_off;
+	const u64 m_size;
+	u64 m_pos = 0;
+
+	file_view(const fs::file& file, const std::shared_ptr<std::mutex>& mutex, u64 offset, u64 size)
+		: m_file(file)
+		, m_mutex(mutex)
+		, m_off(offset)
+		, m_size(size)
+	{
+	}
+
+	bool trunc(u64 length) override
+	{
+		return false;
+	}
+
+	u64 read(void* buffer, u64 size) override
+	{
+		if (m_pos >= m_size)
+		{
+			return 0;
+		}
+
+		std::lock_guard lock(*m_mutex);
+
+		m_file.seek(m_off + m_pos);
+		const u64 result = m_file.read(buffer, std::min<u64>(size, m_size - m_pos));
+		m_pos += result;
+		return result;
+	}
+
+	u64 write(const void* buffer, u64 size) override
+	{
+		return 0;
+	}
+
+	u64 seek(s64 offset, fs::seek_mode whence) override
+	{
+		const s64 new_pos =
+			whence == fs::seek_set ? offset :
+			whence == fs::seek_cur ? offset + m_pos :
+			whence == fs::seek_end ? offset + size() :
+			(fmt::raw_error("pup_object::file_view::seek(): invalid whence"), 0);
+
+		if (new_pos < 0)
+		{
+			fs::g_tls_error = fs::error::inval;
+			return -1;
+		}
+
+		m_pos = new_pos;
+		return m_pos;
+	}
+
+	u64 size() override
+	{
+		return m_size;
+	}
+};
+
 fs::file pup_object::get_file(u64 entry_id)
 {
 	if (!isValid) return fs::file();
@@ -32,11 +103,90 @@ fs::file pup_object::get_file(u64 entry_id)
 	{
 		if (file_entry.entry_id == entry_id)
 		{
-			std::vector<u8> file_buf(file_entry.data_length);
-			m_file.seek(file_entry.data_offset);
-			m_file.read(file_buf, file_entry.data_length);
-			return fs::make_stream(std::move(file_buf));
+			fs::file result;
+			result.reset(std::make_unique<file_view>(m_file, m_mutex, file_entry.data_offset, file_entry.data_length));
+			return result;
 		}
 	}
 	return fs::file();
-};
+}
+
+bool pup_install_update_files(tar_object& update_files, const std::vector<std::string>& filenames, const std::string& dev_flash, atomic_t<int>& progress)
+{
+	// Protects update_files (TAR reader isn't thread-safe)
+	std::mutex tar_mutex;
+
+	// Index of the next file to process
+	atomic_t<std::size_t> next{0};
+
+	atomic_t<bool> failed{false};
+
+	auto install = [&]
+	{
+		for (std::size_t i; !failed && progress >= 0 && (i = next++) < filenames.size();)
+		{
+			fs::file updatefile;
+			{
+				std::lock_guard lock(tar_mutex);
+				updatefile = update_files.get_file(filenames[i]);
+			}
+
+			SCEDecrypter self_dec(updatefile);
+			self_dec.LoadHeaders();
+			self_dec.LoadMetadata(SCEPKG_ERK, SCEPKG_RIV);
+			self_dec.DecryptData();
+
+			auto dev_flash_tar_f = self_dec.MakeFile();
+			if (dev_flash_tar_f.size() < 3)
+			{
+				LOG_ERROR(LOADER, "PUP: contents of %s are invalid.", filenames[i]);
+				failed = true;
+				break;
+			}
+
+			// Release the package before extraction
+			updatefile.close();
+
+			tar_object dev_flash_tar(dev_flash_tar_f[2]);
+			if (!dev_flash_tar.extract(dev_flash, "dev_flash/"))
+			{
+				LOG_ERROR(LOADER, "PUP: TAR contents of %s are invalid.", filenames[i]);
+				failed = true;
+				break;
+			}
+
+			progress.fetch_op([](int& v)
+			{
+				// Don't overwrite cancellation
+				if (v >= 0)
+				{
+					v++;
+				}
+			});
+		}
+	};
+
+	const std::size_t count = std::min<std::size_t>(std::max<u32>(std::thread::hardware_concurrency(), 1), filenames.size());
+
+	std::vector<std::unique_ptr<named_thread<std::function<void()>>>> workers;
+
+	for (std::size_t i = 1; i < count; i++)
+	{
+		workers.emplace_back(std::make_unique<named_thread<std::function<void()>>>(fmt::format("Firmware Installer %u", i), install));
+	}
+
+	// Use current thread too
+	install();
+
+	for (auto& worker : workers)
+	{
+		(*worker)();
+	}
+
+	if (failed)
+	{
+		progress = -1;
+	}
+
+	return !failed && progress >= 0;
+}
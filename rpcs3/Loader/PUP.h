@@ -2,8 +2,11 @@
 
 #include "../../Utilities/types.h"
 #include "../../Utilities/File.h"
+#include "../../Utilities/Atomic.h"
 
 #include <vector>
+#include <memory>
+#include <mutex>
 
 struct PUPHeader
 {
@@ -38,10 +41,22 @@ class pup_object
 	std::vector<PUPFileEntry> m_file_tbl;
 	std::vector<PUPHashEntry> m_hash_tbl;
 
+	// Serializes file access from file views
+	const std::shared_ptr<std::mutex> m_mutex = std::make_shared<std::mutex>();
+
+	struct file_view;
+
 public:
 	pup_object(const fs::file& file);
 
 	explicit operator bool() const { return isValid; };
 
+	// Get read-only view of the entry (file data is not copied, PUP file must outlive it)
 	fs::file get_file(u64 entry_id);
 };
+
+class tar_object;
+
+// Decrypt dev_flash update files on a worker pool and extract them to dev_flash directory.
+// Progress is incremented for every installed file; setting it to -1 cancels the installation.
+bool pup_install_update_files(tar_object& update_files, const std::vector<std::string>& filenames, const std::string& dev_flash, atomic_t<int>& progress);
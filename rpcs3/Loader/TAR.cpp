@@ -2,8 +2,8 @@
 
 #include "TAR.h"
 
-#include <cmath>
 #include <cstdlib>
+#include <cstring>
 
 tar_object::tar_object(const fs::file& file, size_t offset)
 	: m_file(file)
@@ -21,17 +21,17 @@ TARHeader tar_object::read_header(u64 offset)
 	return header;
 }
 
-int octalToDecimal(int octalNumber)
+u64 tar_object::next_offset(u64 offset) const
 {
-	int decimalNumber = 0, i = 0, rem;
-	while (octalNumber != 0)
-	{
-		rem = octalNumber % 10;
-		octalNumber /= 10;
-		decimalNumber += rem * pow(8, i);
-		++i;
-	}
-	return decimalNumber;
+	return ((offset - initial_offset + 512 - 1) & ~u64{512 - 1}) + initial_offset;
+}
+
+static u64 get_size(const TARHeader& header)
+{
+	// Size is stored as octal number
+	char size[sizeof(header.size) + 1]{};
+	std::memcpy(size, header.size, sizeof(header.size));
+	return std::strtoull(size, nullptr, 8);
 }
 
 std::vector<std::string> tar_object::get_filenames()
@@ -53,11 +53,10 @@ fs::file tar_object::get_file(std::string path)
 	if (it != m_map.end())
 	{
 		TARHeader header = read_header(it->second);
-		int size = octalToDecimal(atoi(header.size));
+		const u64 size = get_size(header);
 		std::vector<u8> buf(size);
 		m_file.read(buf, size);
-		int offset = ((m_file.pos() - initial_offset + 512 - 1) & ~(512 - 1)) + initial_offset; // Always keep the offset aligned to 512 bytes + the initial offset.
-		m_file.seek(offset);
+		m_file.seek(next_offset(m_file.pos()));
 		return fs::make_stream(std::move(buf));
 	}
 	else //continue scanning from last file entered
@@ -69,21 +68,16 @@ fs::file tar_object::get_file(std::string path)
 			if (std::string(header.magic).find("ustar") != std::string::npos)
 				m_map[header.name] = largest_offset;
 
-			int size = octalToDecimal(atoi(header.size));
+			const u64 size = get_size(header);
 			if (path.compare(header.name) == 0) { //path is equal, read file and advance offset to start of next block
 				std::vector<u8> buf(size);
 				m_file.read(buf, size);
-				int offset = ((m_file.pos() - initial_offset + 512 - 1) & ~(512 - 1)) + initial_offset;
-				m_file.seek(offset);
-				largest_offset = offset;
+				largest_offset = m_file.seek(next_offset(m_file.pos()));
 
 				return fs::make_stream(std::move(buf));
 			}
 			else { // just advance offset to next block
-				m_file.seek(size, fs::seek_mode::seek_cur);
-				int offset = ((m_file.pos() - initial_offset + 512 - 1) & ~(512 - 1)) + initial_offset;
-				m_file.seek(offset);
-				largest_offset = offset;
+				largest_offset = m_file.seek(next_offset(m_file.pos() + size));
 			}
 		}
 
@@ -95,6 +89,9 @@ bool tar_object::extract(std::string path, std::string ignore)
 {
 	if (!m_file) return false;
 
+	// Intermediate buffer for streaming file contents
+	std::vector<u8> buf(1024 * 1024);
+
 	get_file(""); //Make sure we have scanned all files
 	for (auto iter : m_map)
 	{
@@ -113,13 +110,34 @@ bool tar_object::extract(std::string path, std::string ignore)
 		case '0':
 		{
 			fs::file file(result, fs::rewrite);
-			file.write(get_file(header.name).to_vector<u8>());
+
+			if (!file)
+			{
+				LOG_ERROR(GENERAL, "TAR Loader: failed to create file %s (%s)", result, fs::g_tls_error);
+				return false;
+			}
+
+			// Copy file data directly from the archive
+			for (u64 size = get_size(header); size;)
+			{
+				const u64 count = m_file.read(buf.data(), std::min<u64>(size, buf.size()));
+
+				if (!count)
+				{
+					LOG_ERROR(GENERAL, "TAR Loader: unexpected end of archive (%s)", header.name);
+					return false;
+				}
+
+				file.write(buf.data(), count);
+				size -= count;
+			}
+
 			break;
 		}
 
 		case '5':
 		{
-			fs::create_dir(result);
+			fs::create_path(result);
 			break;
 		}
 
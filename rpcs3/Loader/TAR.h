@@ -21,18 +21,20 @@ class tar_object
 {
 	const fs::file& m_file;
 
-	int initial_offset;
-	int largest_offset; //we store the largest offset so we can continue to scan from there.
+	u64 initial_offset;
+	u64 largest_offset; //we store the largest offset so we can continue to scan from there.
 	std::map<std::string, u64> m_map; //maps path to offset of header of that file, so we only need to scan the entire file once.
 
 	TARHeader read_header(u64 offset);
 
+	u64 next_offset(u64 offset) const; // Align offset to 512 bytes + the initial offset
+
 public:
 	tar_object(const fs::file& file, size_t offset = 0);
 
 	std::vector<std::string> get_filenames();
 
-	fs::file get_file(std::string path);
+	fs::file get_file(std::string path); // read file into memory (not thread-safe)
 
-	bool extract(std::string path, std::string ignore = ""); // extract all files in archive to path
+	bool extract(std::string path, std::string ignore = ""); // extract all files in archive to path (streamed, not thread-safe)
 };
@@ -0,0 +1,236 @@
+// Index buffer decoding benchmark (rpcs3/Emu/RSX/Common/index_decoder.h).
+//
+// Times upload_untouched, expand_indexed_quads and expand_indexed_triangle_fan for u16 and u32
+// indices with every decoder available on this CPU, and checks the SIMD results against the scalar path.
+//
+// Usage: index_buffer_bench [index count] [iterations]
+
+#include "Emu/RSX/Common/index_decoder.h"
+#include "Utilities/sysinfo.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using steady = std::chrono::steady_clock;
+
+	// Same checks as utils::has_sse41() and utils::has_avx2() (sysinfo.cpp pulls in the file system code)
+#if defined(_MSC_VER) || defined(__SSE4_1__)
+	bool cpu_has_sse41()
+	{
+		return utils::get_cpuid(0, 0)[0] >= 0x1 && utils::get_cpuid(1, 0)[2] & 0x80000;
+	}
+#endif
+
+#if defined(_MSC_VER) || defined(__AVX2__)
+	bool cpu_has_avx2()
+	{
+		return utils::get_cpuid(0, 0)[0] >= 0x7 && utils::get_cpuid(7, 0)[1] & 0x20 && (utils::get_cpuid(1, 0)[2] & 0x0C000000) == 0x0C000000 && (utils::get_xgetbv(0) & 0x6) == 0x6;
+	}
+#endif
+
+	enum class expansion
+	{
+		untouched,
+		quads,
+		fan,
+	};
+
+	const char* get_name(expansion mode)
+	{
+		switch (mode)
+		{
+		case expansion::untouched: return "untouched";
+		case expansion::quads: return "quads";
+		case expansion::fan: return "fan";
+		}
+
+		return "?";
+	}
+
+	struct index_result
+	{
+		std::tuple<u32, u32, u32> ret;
+		std::vector<u32> data;
+
+		bool operator==(const index_result& rhs) const
+		{
+			return ret == rhs.ret && data == rhs.data;
+		}
+	};
+
+	// One input set: big endian indices, primitive restart is enabled if restart_rate is not 0
+	template <typename T>
+	struct index_source
+	{
+		std::vector<be_t<T>> indices;
+		rsx::index_decoder_args args;
+		bool skip_restart;
+	};
+
+	template <typename T>
+	index_source<T> make_source(u32 count, u32 restart_rate, u32 base_index, bool skip_restart)
+	{
+		std::mt19937 rng(count ^ restart_rate);
+
+		const u32 restart_index = sizeof(T) == 2 ? 0xffff : 0xffffffff;
+
+		index_source<T> result{{}, {restart_rate != 0, restart_index, base_index}, skip_restart};
+		result.indices.reserve(count);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			if (restart_rate && rng() % restart_rate == 0)
+			{
+				result.indices.emplace_back(static_cast<T>(restart_index));
+			}
+			else
+			{
+				// u32 indices exceed the 20-bit mask applied after rebasing
+				result.indices.emplace_back(static_cast<T>(rng() % 0x200000));
+			}
+		}
+
+		return result;
+	}
+
+	template <typename T, typename Decoder>
+	std::tuple<u32, u32, u32> expand(expansion mode, const index_source<T>& src, gsl::span<u32> dst)
+	{
+		const gsl::span<const be_t<T>> input{src.indices.data(), static_cast<std::ptrdiff_t>(src.indices.size())};
+
+		switch (mode)
+		{
+		case expansion::untouched: return rsx::upload_untouched<T, Decoder>(input, dst, src.args, src.skip_restart);
+		case expansion::quads: return rsx::expand_indexed_quads<T, Decoder>(input, dst, src.args);
+		case expansion::fan: return rsx::expand_indexed_triangle_fan<T, Decoder>(input, dst, src.args);
+		}
+
+		return {};
+	}
+
+	template <typename T, typename Decoder>
+	index_result run_once(expansion mode, const index_source<T>& src)
+	{
+		index_result result;
+		result.data.resize(src.indices.size() * 3);
+		result.ret = expand<T, Decoder>(mode, src, {result.data.data(), static_cast<std::ptrdiff_t>(result.data.size())});
+		result.data.resize(std::get<2>(result.ret));
+		return result;
+	}
+
+	// Returns the best time in milliseconds
+	template <typename T, typename Decoder>
+	double time_decoder(expansion mode, const index_source<T>& src, u32 iterations)
+	{
+		std::vector<u32> dst(src.indices.size() * 3);
+		double best = 1e30;
+
+		for (u32 i = 0; i < iterations; i++)
+		{
+			const auto start = steady::now();
+			const auto ret = expand<T, Decoder>(mode, src, {dst.data(), static_cast<std::ptrdiff_t>(dst.size())});
+			const double time = std::chrono::duration<double, std::milli>(steady::now() - start).count();
+
+			// Keep the result alive
+			if (std::get<2>(ret) > dst.size())
+			{
+				std::abort();
+			}
+
+			best = std::min(best, time);
+		}
+
+		return best;
+	}
+
+	u32 g_failures = 0;
+
+	// Check the decoder against the scalar path with small inputs covering every tail length and restart density
+	template <typename T, typename Decoder>
+	bool verify_decoder(expansion mode)
+	{
+		for (u32 count = 3; count < 80; count++)
+		{
+			for (u32 restart_rate : {0u, 2u, 5u, 64u})
+			{
+				for (bool skip_restart : {false, true})
+				{
+					const auto src = make_source<T>(count, restart_rate, count * 0x1111, skip_restart);
+
+					if (!(run_once<T, Decoder>(mode, src) == run_once<T, rsx::index_decoder_scalar<T>>(mode, src)))
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	template <typename T, typename Decoder>
+	void bench_decoder(const char* name, expansion mode, const index_source<T>& src, const index_result& reference, u32 iterations)
+	{
+		const bool ok = verify_decoder<T, Decoder>(mode) && run_once<T, Decoder>(mode, src) == reference;
+		const double time = time_decoder<T, Decoder>(mode, src, iterations);
+
+		if (!ok)
+		{
+			g_failures++;
+		}
+
+		std::printf("u%-2zu %-10s %-7s %8.3f ms %9.1f Mindex/s  %s\n", sizeof(T) * 8, get_name(mode), name,
+			time, src.indices.size() / time / 1000., ok ? "ok" : "MISMATCH");
+	}
+
+	template <typename T>
+	void bench_type(u32 count, u32 iterations)
+	{
+		// Sparse restarts (strips separated by restart), same input for every decoder
+		const auto src = make_source<T>(count, 256, 0x1234, false);
+
+		for (expansion mode : {expansion::untouched, expansion::quads, expansion::fan})
+		{
+			const auto reference = run_once<T, rsx::index_decoder_scalar<T>>(mode, src);
+
+			bench_decoder<T, rsx::index_decoder_scalar<T>>("scalar", mode, src, reference, iterations);
+
+#if defined(_MSC_VER) || defined(__SSE4_1__)
+			if (cpu_has_sse41())
+			{
+				bench_decoder<T, rsx::index_decoder_sse41<T>>("sse4.1", mode, src, reference, iterations);
+			}
+#endif
+#if defined(_MSC_VER) || defined(__AVX2__)
+			if (cpu_has_avx2())
+			{
+				bench_decoder<T, rsx::index_decoder_avx2<T>>("avx2", mode, src, reference, iterations);
+			}
+#endif
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const u32 count = argc > 1 ? std::max<u32>(std::strtoul(argv[1], nullptr, 10), 4) : 1 << 20;
+	const u32 iterations = argc > 2 ? std::max<u32>(std::strtoul(argv[2], nullptr, 10), 1) : 50;
+
+	std::printf("Index buffer decoding: %u indices, best of %u iterations\n", count, iterations);
+
+	bench_type<u16>(count, iterations);
+	bench_type<u32>(count, iterations);
+
+	if (g_failures)
+	{
+		std::printf("%u decoder(s) don't match the scalar path\n", g_failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,388 @@
+// Loopback ping-pong benchmark for the sys_net network thread (Linux only).
+//
+// A "guest" thread sends one byte over a TCP loopback connection, enables read interest
+// and sleeps until the network thread reports the echo, like a blocking sys_net_bnet_recvfrom.
+// The network thread runs either:
+//   poll  - the old loop (still used on other platforms): pollfd array rebuilt every iteration, poll() with a 1 ms timeout
+//   epoll - the network thread loop of sys_net.cpp driving net_reactor (rpcs3/Emu/Cell/lv2/sys_net_reactor.h)
+//
+// Usage: net_loopback_bench [iterations] [idle sockets]
+
+#include "Emu/Cell/lv2/sys_net_reactor.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	using steady = std::chrono::steady_clock;
+
+	[[noreturn]] void fail(const char* what)
+	{
+		std::perror(what);
+		std::exit(1);
+	}
+
+	// Shared state between the guest thread and the network thread
+	class net_model
+	{
+	protected:
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+
+		// All sockets owned by the emulated process (the connection and idle sockets)
+		std::vector<int> m_sockets;
+
+		// Socket with pending read interest, -1 if none
+		int m_wanted = -1;
+		bool m_ready = false;
+
+		std::atomic<bool> m_stop{false};
+
+		// Called by the network thread when the socket with read interest became readable
+		void signal_ready()
+		{
+			m_wanted = -1;
+			m_ready = true;
+			m_cv.notify_one();
+		}
+
+	public:
+		explicit net_model(std::vector<int> sockets)
+			: m_sockets(std::move(sockets))
+		{
+		}
+
+		virtual ~net_model() = default;
+
+		virtual const char* name() const = 0;
+
+		// Network thread body
+		virtual void run() = 0;
+
+		// Enable read interest for the socket (guest thread)
+		virtual void request_read(int fd) = 0;
+
+		virtual void stop()
+		{
+			m_stop = true;
+		}
+
+		// Sleep until the network thread reports readiness (guest thread)
+		void wait_ready()
+		{
+			std::unique_lock lock(m_mutex);
+			m_cv.wait(lock, [&] { return m_ready; });
+			m_ready = false;
+		}
+	};
+
+	class poll_model final : public net_model
+	{
+	public:
+		using net_model::net_model;
+
+		const char* name() const override
+		{
+			return "poll (1 ms)";
+		}
+
+		void request_read(int fd) override
+		{
+			// Picked up on the next iteration, the network thread is not woken
+			std::lock_guard lock(m_mutex);
+			m_wanted = fd;
+		}
+
+		void run() override
+		{
+			std::vector<::pollfd> fds;
+
+			while (!m_stop)
+			{
+				// Obtain all active sockets
+				{
+					std::lock_guard lock(m_mutex);
+
+					fds.clear();
+
+					for (int fd : m_sockets)
+					{
+						fds.push_back({fd, static_cast<short>(fd == m_wanted ? POLLIN : 0), 0});
+					}
+				}
+
+				// Wait with 1ms timeout
+				::poll(fds.data(), fds.size(), 1);
+
+				std::lock_guard lock(m_mutex);
+
+				for (const auto& pfd : fds)
+				{
+					if (pfd.revents & (POLLIN | POLLHUP) && pfd.fd == m_wanted)
+					{
+						signal_ready();
+					}
+				}
+			}
+		}
+	};
+
+	// Stand-in for lv2_socket
+	struct bench_socket final : std::enable_shared_from_this<bench_socket>
+	{
+		enum class poll
+		{
+			read,
+			write,
+			error,
+
+			__bitset_enum_max
+		};
+
+		explicit bench_socket(int s)
+			: socket(s)
+		{
+		}
+
+		int socket;
+
+		atomic_bs_t<poll> events{};
+	};
+
+	class epoll_model final : public net_model
+	{
+		net_reactor<bench_socket> m_reactor;
+
+		std::unordered_map<int, std::shared_ptr<bench_socket>> m_objects;
+
+	public:
+		explicit epoll_model(std::vector<int> sockets)
+			: net_model(std::move(sockets))
+		{
+			for (int fd : m_sockets)
+			{
+				m_objects.emplace(fd, std::make_shared<bench_socket>(fd));
+			}
+
+			// Idle sockets have no interest and are never registered
+			if (!m_reactor.open())
+			{
+				fail("epoll");
+			}
+		}
+
+		const char* name() const override
+		{
+			return "epoll";
+		}
+
+		void request_read(int fd) override
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				m_wanted = fd;
+			}
+
+			if (!m_reactor.add(*m_objects.at(fd), bench_socket::poll::read))
+			{
+				fail("eventfd write");
+			}
+		}
+
+		void stop() override
+		{
+			net_model::stop();
+			m_reactor.wake();
+		}
+
+		// Same loop as network_thread_init() in sys_net.cpp
+		void run() override
+		{
+			while (!m_stop)
+			{
+				const int count = m_reactor.wait(100);
+
+				std::lock_guard lock(m_mutex);
+
+				if (!m_reactor.process(count, [&](bench_socket& sock, bs_t<bench_socket::poll> events)
+				{
+					if (events & bench_socket::poll::read && sock.socket == m_wanted)
+					{
+						signal_ready();
+					}
+				}))
+				{
+					fail("eventfd read");
+				}
+
+				m_reactor.update([](bench_socket&, int error)
+				{
+					errno = error;
+					fail("epoll_ctl");
+				});
+			}
+		}
+	};
+
+	void set_nodelay(int fd)
+	{
+		const int one = 1;
+		::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	}
+
+	// Returns a connected (client, server) pair on 127.0.0.1
+	std::pair<int, int> make_connection()
+	{
+		const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+
+		::sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+
+		::socklen_t len = sizeof(addr);
+
+		if (listener == -1 ||
+			::bind(listener, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr)) != 0 ||
+			::listen(listener, 1) != 0 ||
+			::getsockname(listener, reinterpret_cast<::sockaddr*>(&addr), &len) != 0)
+		{
+			fail("listen");
+		}
+
+		const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+
+		if (client == -1 || ::connect(client, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr)) != 0)
+		{
+			fail("connect");
+		}
+
+		const int server = ::accept(listener, nullptr, nullptr);
+
+		if (server == -1)
+		{
+			fail("accept");
+		}
+
+		::close(listener);
+		set_nodelay(client);
+		set_nodelay(server);
+		return {client, server};
+	}
+
+	template <typename Model>
+	void run_benchmark(std::size_t iterations, std::size_t idle_count)
+	{
+		const auto [client, server] = make_connection();
+
+		std::vector<int> sockets{client};
+
+		for (std::size_t i = 0; i < idle_count; i++)
+		{
+			const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+
+			if (fd == -1)
+			{
+				fail("socket");
+			}
+
+			sockets.push_back(fd);
+		}
+
+		// Remote peer
+		std::thread echo([server = server]
+		{
+			char c;
+
+			while (::recv(server, &c, 1, 0) == 1)
+			{
+				if (::send(server, &c, 1, 0) != 1)
+				{
+					break;
+				}
+			}
+		});
+
+		Model model(sockets);
+
+		std::thread network([&] { model.run(); });
+
+		std::vector<double> rtt;
+		rtt.reserve(iterations);
+
+		for (std::size_t i = 0; i < iterations; i++)
+		{
+			char c = static_cast<char>(i);
+
+			const auto start = steady::now();
+
+			if (::send(client, &c, 1, 0) != 1)
+			{
+				fail("send");
+			}
+
+			model.request_read(client);
+			model.wait_ready();
+
+			if (::recv(client, &c, 1, 0) != 1)
+			{
+				fail("recv");
+			}
+
+			rtt.push_back(std::chrono::duration<double, std::micro>(steady::now() - start).count());
+		}
+
+		model.stop();
+		network.join();
+
+		::shutdown(client, SHUT_RDWR);
+		echo.join();
+
+		for (int fd : sockets)
+		{
+			::close(fd);
+		}
+
+		::close(server);
+
+		std::sort(rtt.begin(), rtt.end());
+
+		double sum = 0;
+
+		for (double v : rtt)
+		{
+			sum += v;
+		}
+
+		std::printf("%-12s  min %9.1f  median %9.1f  p99 %9.1f  mean %9.1f us\n", model.name(),
+			rtt.front(), rtt[rtt.size() / 2], rtt[rtt.size() * 99 / 100], sum / rtt.size());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t iterations = argc > 1 ? std::max<std::size_t>(std::strtoull(argv[1], nullptr, 10), 1) : 2000;
+	const std::size_t idle_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+
+	std::printf("TCP loopback ping-pong: %zu iterations, %zu idle sockets\n", iterations, idle_count);
+
+	run_benchmark<poll_model>(iterations, idle_count);
+	run_benchmark<epoll_model>(iterations, idle_count);
+	return 0;
+}
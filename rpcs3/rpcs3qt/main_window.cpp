@@ -579,40 +579,11 @@ void main_window::InstallPup(const QString& dropPath)
 		// Run asynchronously
 		named_thread worker("Firmware Installer", [&]
 		{
-			for (const auto& updatefilename : updatefilenames)
-			{
-				if (progress == -1) break;
-
-				fs::file updatefile = update_files.get_file(updatefilename);
-
-				SCEDecrypter self_dec(updatefile);
-				self_dec.LoadHeaders();
-				self_dec.LoadMetadata(SCEPKG_ERK, SCEPKG_RIV);
-				self_dec.DecryptData();
-
-				auto dev_flash_tar_f = self_dec.MakeFile();
-				if (dev_flash_tar_f.size() < 3)
-				{
-					LOG_ERROR(GENERAL, "Error while installing firmware: PUP contents are invalid.");
-					QMessageBox::critical(this, tr("Failure!"), tr("Error while installing firmware: PUP contents are invalid."));
-					progress = -1;
-				}
-
-				tar_object dev_flash_tar(dev_flash_tar_f[2]);
-				if (!dev_flash_tar.extract(g_cfg.vfs.get_dev_flash(), "dev_flash/"))
-				{
-					LOG_ERROR(GENERAL, "Error while installing firmware: TAR contents are invalid.");
-					QMessageBox::critical(this, tr("Failure!"), tr("Error while installing firmware: TAR contents are invalid."));
-					progress = -1;
-				}
-
-				if (progress >= 0)
-					progress += 1;
-			}
+			pup_install_update_files(update_files, updatefilenames, g_cfg.vfs.get_dev_flash(), progress);
 		});
 
 		// Wait for the completion
-		while (std::this_thread::sleep_for(5ms), std::abs(progress) < pdlg.maximum())
+		while (std::this_thread::sleep_for(5ms), progress >= 0 && progress < pdlg.maximum())
 		{
 			if (pdlg.wasCanceled())
 			{
@@ -624,6 +595,15 @@ void main_window::InstallPup(const QString& dropPath)
 			QCoreApplication::processEvents();
 		}
 
+		// Wait for the worker pool to stop
+		worker();
+
+		if (progress < 0 && !pdlg.wasCanceled())
+		{
+			LOG_ERROR(GENERAL, "Error while installing firmware: PUP contents are invalid.");
+			QMessageBox::critical(this, tr("Failure!"), tr("Error while installing firmware: PUP contents are invalid."));
+		}
+
 		update_files_f.close();
 		pup_f.close();
 
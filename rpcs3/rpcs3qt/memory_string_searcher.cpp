@@ -1,8 +1,20 @@
-
 #include "memory_string_searcher.h"
+#include "Emu/Memory/vm_search.h"
 
 #include <QLabel>
 
+enum search_mode : int
+{
+	mode_string,
+	mode_hex,
+	mode_u8,
+	mode_u16,
+	mode_u32,
+	mode_u64,
+	mode_f32,
+	mode_f64,
+};
+
 memory_string_searcher::memory_string_searcher(QWidget* parent)
 	: QDialog(parent)
 {
@@ -14,63 +26,110 @@ memory_string_searcher::memory_string_searcher(QWidget* parent)
 	m_addr_line->setFixedWidth(QLabel("This is the very length of the lineedit due to hidpi reasons.").sizeHint().width());
 	m_addr_line->setPlaceholderText(tr("Search..."));
 
+	m_mode = new QComboBox(this);
+	m_mode->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+	m_mode->addItem(tr("String"), mode_string);
+	m_mode->addItem(tr("Hex bytes (?? = any)"), mode_hex);
+	m_mode->addItem(tr("u8"), mode_u8);
+	m_mode->addItem(tr("u16"), mode_u16);
+	m_mode->addItem(tr("u32"), mode_u32);
+	m_mode->addItem(tr("u64"), mode_u64);
+	m_mode->addItem(tr("f32"), mode_f32);
+	m_mode->addItem(tr("f64"), mode_f64);
+
 	QPushButton* button_search = new QPushButton(tr("&Search"), this);
 
+	m_button_narrow = new QPushButton(tr("&Narrow"), this);
+	m_button_narrow->setEnabled(false);
+
 	QHBoxLayout* hbox_panel = new QHBoxLayout();
+	hbox_panel->addWidget(m_mode);
 	hbox_panel->addWidget(m_addr_line);
 	hbox_panel->addWidget(button_search);
+	hbox_panel->addWidget(m_button_narrow);
 
 	setLayout(hbox_panel);
 
 	connect(button_search, &QAbstractButton::clicked, this, &memory_string_searcher::OnSearch);
+	connect(m_button_narrow, &QAbstractButton::clicked, this, &memory_string_searcher::OnNarrow);
 
 	layout()->setSizeConstraint(QLayout::SetFixedSize);
 };
 
+static vm::search_pattern get_pattern(int mode, const QString& text)
+{
+	bool ok = true;
+
+	vm::search_pattern result;
+
+	switch (mode)
+	{
+	case mode_string: result = vm::search_pattern::from_string(text.toStdString()); break;
+	case mode_hex: result = vm::search_pattern::from_hex(text.toStdString()); break;
+	case mode_u8:
+	{
+		// Qt has no 8-bit conversion, reject values which don't fit instead of truncating them
+		const u16 value = text.toUShort(&ok, 0);
+		ok = ok && value <= 0xff;
+		result = vm::search_pattern::from_value<u8>(static_cast<u8>(value));
+		break;
+	}
+	case mode_u16: result = vm::search_pattern::from_value<u16>(text.toUShort(&ok, 0)); break;
+	case mode_u32: result = vm::search_pattern::from_value<u32>(text.toUInt(&ok, 0)); break;
+	case mode_u64: result = vm::search_pattern::from_value<u64>(text.toULongLong(&ok, 0)); break;
+	case mode_f32: result = vm::search_pattern::from_value<f32>(text.toFloat(&ok)); break;
+	case mode_f64: result = vm::search_pattern::from_value<f64>(text.toDouble(&ok)); break;
+	default: break;
+	}
+
+	return ok ? result : vm::search_pattern{};
+}
+
+static void log_results(const std::vector<u32>& results)
+{
+	// Don't flood the log with value search results
+	for (std::size_t i = 0; i < results.size() && i < 1000; i++)
+	{
+		LOG_NOTICE(GENERAL, "Found @ 0x%08x", results[i]);
+	}
+
+	LOG_NOTICE(GENERAL, "Search completed (found %u matches)", results.size());
+}
+
 void memory_string_searcher::OnSearch()
 {
-	const QString wstr = m_addr_line->text();
-	const char *str = wstr.toStdString().c_str();
-	const u32 len = wstr.length();
+	const std::string str = m_addr_line->text().toStdString();
+	const auto pattern = get_pattern(m_mode->currentData().toInt(), m_addr_line->text());
+
+	if (pattern.empty())
+	{
+		LOG_ERROR(GENERAL, "Invalid search pattern: %s", str);
+		return;
+	}
+
+	LOG_NOTICE(GENERAL, "Searching for %s", str);
+
+	m_results = vm::search(pattern);
+	m_button_narrow->setEnabled(!m_results.empty());
+
+	log_results(m_results);
+}
 
-	LOG_NOTICE(GENERAL, "Searching for string %s", str);
+void memory_string_searcher::OnNarrow()
+{
+	const std::string str = m_addr_line->text().toStdString();
+	const auto pattern = get_pattern(m_mode->currentData().toInt(), m_addr_line->text());
 
-	// Search the address space for the string
-	u32 strIndex = 0;
-	u32 numFound = 0;
-	const auto area = vm::get(vm::main);
-	for (u32 addr = area->addr; addr < area->addr + area->size; addr++)
+	if (pattern.empty())
 	{
-		if (!vm::check_addr(addr))
-		{
-			strIndex = 0;
-			continue;
-		}
-
-		u8 byte = vm::read8(addr);
-		if (byte == str[strIndex])
-		{
-			if (strIndex == len)
-			{
-				// Found it
-				LOG_NOTICE(GENERAL, "Found @ %04x", addr - len);
-				numFound++;
-				strIndex = 0;
-				continue;
-			}
-
-			strIndex++;
-		}
-		else
-		{
-			strIndex = 0;
-		}
-
-		if (addr % (1024 * 1024 * 64) == 0) // Log every 64mb
-		{
-			LOG_NOTICE(GENERAL, "Searching %04x ...", addr);
-		}
+		LOG_ERROR(GENERAL, "Invalid search pattern: %s", str);
+		return;
 	}
 
-	LOG_NOTICE(GENERAL, "Search completed (found %d matches)", numFound);
+	LOG_NOTICE(GENERAL, "Narrowing %u previous results to %s", m_results.size(), str);
+
+	m_results = vm::search_narrow(pattern, m_results);
+	m_button_narrow->setEnabled(!m_results.empty());
+
+	log_results(m_results);
 }
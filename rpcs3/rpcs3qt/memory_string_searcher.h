@@ -7,6 +7,7 @@
 #include <QDialog>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QComboBox>
 #include <QHBoxLayout>
 
 class memory_string_searcher : public QDialog
@@ -14,10 +15,16 @@ class memory_string_searcher : public QDialog
 	Q_OBJECT
 
 	QLineEdit* m_addr_line;
+	QComboBox* m_mode;
+	QPushButton* m_button_narrow;
+
+	// Results of the previous search (for narrowing)
+	std::vector<u32> m_results;
 
 public:
 	memory_string_searcher(QWidget* parent);
 
 private Q_SLOTS:
 	void OnSearch();
+	void OnNarrow();
 };
@@ -0,0 +1,97 @@
+// EDATADecrypter read-ahead window (rpcs3/Crypto/unedat_read_ahead.h)
+
+#include "Crypto/unedat_read_ahead.h"
+#include "test.h"
+
+#include <vector>
+
+namespace
+{
+	// Read blocks [first, last) and collect the blocks the read-ahead thread would decrypt
+	std::vector<u32> read(edat_read_ahead& ra, u32 first, u32 last, u32 total_blocks = 1000)
+	{
+		std::vector<u32> result;
+
+		if (ra.update(first, last, total_blocks))
+		{
+			for (u32 block; ra.pop(block);)
+			{
+				result.push_back(block);
+			}
+		}
+
+		return result;
+	}
+
+	std::vector<u32> range(u32 first, u32 last)
+	{
+		std::vector<u32> result;
+
+		for (u32 i = first; i < last; i++)
+		{
+			result.push_back(i);
+		}
+
+		return result;
+	}
+}
+
+int main()
+{
+	const u32 n = edat_read_ahead::max_blocks;
+
+	// First read is not sequential
+	{
+		edat_read_ahead ra;
+		TEST_CHECK(read(ra, 0, 1).empty());
+		TEST_CHECK(read(ra, 1, 2) == range(2, 2 + n));
+		TEST_CHECK(read(ra, 2, 3) == range(2 + n, 3 + n));
+	}
+
+	// Seek backward, then read sequentially again: prefetch must restart at the new position
+	{
+		edat_read_ahead ra;
+		read(ra, 100, 101);
+		TEST_CHECK(read(ra, 101, 102) == range(102, 102 + n));
+
+		TEST_CHECK(read(ra, 10, 11).empty());
+		TEST_CHECK(read(ra, 11, 12) == range(12, 12 + n));
+		TEST_CHECK(read(ra, 12, 13) == range(12 + n, 13 + n));
+	}
+
+	// Seek forward past the window
+	{
+		edat_read_ahead ra;
+		read(ra, 0, 1);
+		TEST_CHECK(read(ra, 1, 2) == range(2, 2 + n));
+
+		TEST_CHECK(read(ra, 500, 501).empty());
+		TEST_CHECK(read(ra, 501, 502) == range(502, 502 + n));
+	}
+
+	// Re-reading the same block keeps the window progress
+	{
+		edat_read_ahead ra;
+		read(ra, 0, 1);
+		TEST_CHECK(read(ra, 1, 2) == range(2, 2 + n));
+		TEST_CHECK(read(ra, 1, 2).empty());
+	}
+
+	// Window is clamped to the end of file
+	{
+		edat_read_ahead ra;
+		read(ra, 0, 1, 5);
+		TEST_CHECK(read(ra, 1, 2, 5) == range(2, 5));
+		TEST_CHECK(read(ra, 2, 5, 5).empty());
+	}
+
+	// Empty reads don't change the state
+	{
+		edat_read_ahead ra;
+		read(ra, 0, 1);
+		TEST_CHECK(read(ra, 1, 1).empty());
+		TEST_CHECK(read(ra, 1, 2) == range(2, 2 + n));
+	}
+
+	return test_result();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the standalone tests (main returns test_result())
+inline int g_test_failures = 0;
+
+#define TEST_CHECK(...) do\
+{\
+	if (!(__VA_ARGS__))\
+	{\
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__);\
+		g_test_failures++;\
+	}\
+} while (0)
+
+inline int test_result()
+{
+	if (g_test_failures)
+	{
+		std::fprintf(stderr, "%d check(s) failed\n", g_test_failures);
+		return 1;
+	}
+
+	return 0;
+}